@@ -0,0 +1,193 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// Alarm rules evaluated natively on every analyzed frame. Rules are compiled
+// into a flat instruction list that reads from a per-frame metric vector
+// ([min, max, avg] for each line, then for each ROI) so evaluation is a
+// branch-light loop with no lookups by name.
+
+enum class AlarmSource : uint8_t { LINE, ROI };
+enum class AlarmMetric : uint8_t { MIN = 0, MAX = 1, AVG = 2, COOLING_RATE = 3 };
+enum class AlarmOp : uint8_t { GREATER, LESS };
+
+static constexpr int ALARM_VALUES_PER_SOURCE = 3;
+
+// User-facing rule, e.g. "ROI 0 max > 1450 for 5 frames" or
+// "line 1 cooling rate of max between 800 and 500 °C < 150 °C/s"
+struct AlarmRule {
+    std::string id;
+    AlarmSource source = AlarmSource::ROI;
+    int index = 0;
+    AlarmMetric metric = AlarmMetric::MAX;
+    AlarmMetric rateOf = AlarmMetric::MAX;  // Base metric for COOLING_RATE
+    AlarmOp op = AlarmOp::GREATER;
+    float threshold = 0;
+    int frames = 1;                         // Consecutive frames before raising
+    float bandHigh = 800;                   // COOLING_RATE only applies inside the band
+    float bandLow = 500;
+};
+
+struct AlarmEvent {
+    std::string ruleId;
+    int64_t frame;
+    double timestamp;
+    float value;
+    bool raised;  // false when the condition clears
+};
+
+class AlarmPlan {
+private:
+    struct Instruction {
+        uint32_t slot;
+        AlarmSource source;
+        AlarmMetric metric;
+        AlarmOp op;
+        float threshold;
+        int frames;
+        float bandHigh;
+        float bandLow;
+
+        // Same rule, wherever its source sits in the metric vector: slots
+        // move when lines or ROIs are added or removed in front of it
+        bool sameDefinition(const Instruction& other) const {
+            return source == other.source &&
+                   slot % ALARM_VALUES_PER_SOURCE == other.slot % ALARM_VALUES_PER_SOURCE &&
+                   metric == other.metric && op == other.op &&
+                   threshold == other.threshold && frames == other.frames &&
+                   bandHigh == other.bandHigh && bandLow == other.bandLow;
+        }
+    };
+
+    struct State {
+        int consecutive = 0;
+        bool active = false;
+        float previousValue = std::numeric_limits<float>::quiet_NaN();
+        double previousTime = 0;
+    };
+
+    std::vector<Instruction> instructions;
+    std::vector<State> states;
+    std::vector<std::string> ruleIds;
+    std::vector<std::string> retired;  // Raised rules that were removed; cleared by evaluate()
+
+    // Carry the state of rules whose id and definition are unchanged over
+    // from the previous plan, also when their slot moved; raised rules that
+    // are gone are retired
+    void inherit(const std::vector<Instruction>& previous, const std::vector<State>& previousStates,
+                 const std::vector<std::string>& previousIds) {
+        states.assign(instructions.size(), State());
+        std::vector<bool> kept(previous.size(), false);
+
+        for (size_t i = 0; i < instructions.size(); i++) {
+            for (size_t j = 0; j < previous.size(); j++) {
+                if (!kept[j] && previousIds[j] == ruleIds[i] && previous[j].sameDefinition(instructions[i])) {
+                    states[i] = previousStates[j];
+                    kept[j] = true;
+                    break;
+                }
+            }
+        }
+
+        for (size_t j = 0; j < previous.size(); j++) {
+            if (!kept[j] && previousStates[j].active) {
+                retired.push_back(previousIds[j]);
+            }
+        }
+    }
+
+public:
+    // Compile rules against the current geometry; returns an error message
+    // on failure and leaves the plan empty. Rules that did not change keep
+    // their state, so recompiling neither re-raises nor drops their alarms.
+    std::string compile(const std::vector<AlarmRule>& rules, size_t lineCount, size_t regionCount) {
+        std::vector<Instruction> previous;
+        std::vector<State> previousStates;
+        std::vector<std::string> previousIds;
+        previous.swap(instructions);
+        previousStates.swap(states);
+        previousIds.swap(ruleIds);
+
+        for (const auto& rule : rules) {
+            size_t limit = rule.source == AlarmSource::LINE ? lineCount : regionCount;
+            if (rule.index < 0 || static_cast<size_t>(rule.index) >= limit) {
+                instructions.clear();
+                ruleIds.clear();
+                inherit(previous, previousStates, previousIds);
+                return "Rule " + rule.id + " references a missing " +
+                       (rule.source == AlarmSource::LINE ? "line" : "ROI");
+            }
+
+            size_t sourceIndex = rule.source == AlarmSource::LINE ? rule.index : lineCount + rule.index;
+            AlarmMetric base = rule.metric == AlarmMetric::COOLING_RATE ? rule.rateOf : rule.metric;
+
+            Instruction instruction;
+            instruction.slot = static_cast<uint32_t>(sourceIndex * ALARM_VALUES_PER_SOURCE + static_cast<int>(base));
+            instruction.source = rule.source;
+            instruction.metric = rule.metric;
+            instruction.op = rule.op;
+            instruction.threshold = rule.threshold;
+            instruction.frames = std::max(1, rule.frames);
+            instruction.bandHigh = std::max(rule.bandHigh, rule.bandLow);
+            instruction.bandLow = std::min(rule.bandHigh, rule.bandLow);
+
+            instructions.push_back(instruction);
+            ruleIds.push_back(rule.id);
+        }
+
+        inherit(previous, previousStates, previousIds);
+        return "";
+    }
+
+    bool empty() const {
+        return instructions.empty() && retired.empty();
+    }
+
+    // values holds ALARM_VALUES_PER_SOURCE entries per line and ROI; NaN marks
+    // a source without valid samples. timeMs drives the cooling-rate slope.
+    void evaluate(const std::vector<float>& values, int64_t frame, double timeMs,
+                  std::vector<AlarmEvent>& events) {
+        for (const auto& ruleId : retired) {
+            events.push_back({ ruleId, frame, timeMs, std::numeric_limits<float>::quiet_NaN(), false });
+        }
+        retired.clear();
+
+        for (size_t i = 0; i < instructions.size(); i++) {
+            const Instruction& in = instructions[i];
+            State& state = states[i];
+
+            float value = in.slot < values.size() ? values[in.slot] : std::numeric_limits<float>::quiet_NaN();
+
+            if (in.metric == AlarmMetric::COOLING_RATE) {
+                float current = value;
+                bool inBand = current <= in.bandHigh && current >= in.bandLow;
+                bool previousInBand = state.previousValue <= in.bandHigh && state.previousValue >= in.bandLow;
+                double dt = (timeMs - state.previousTime) / 1000.0;
+
+                value = (inBand && previousInBand && dt > 0)
+                    ? static_cast<float>((state.previousValue - current) / dt)
+                    : std::numeric_limits<float>::quiet_NaN();
+
+                state.previousValue = current;
+                state.previousTime = timeMs;
+            }
+
+            // NaN compares false, so missing data never satisfies a rule
+            bool condition = in.op == AlarmOp::GREATER ? value > in.threshold : value < in.threshold;
+
+            state.consecutive = condition ? state.consecutive + 1 : 0;
+
+            if (!state.active && state.consecutive >= in.frames) {
+                state.active = true;
+                events.push_back({ ruleIds[i], frame, timeMs, value, true });
+            } else if (state.active && !condition) {
+                state.active = false;
+                events.push_back({ ruleIds[i], frame, timeMs, value, false });
+            }
+        }
+    }
+};
@@ -0,0 +1,153 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <memory>
+#include <vector>
+#include <string>
+#include <thread>
+#include <iostream>
+#include "async_task.cpp"
+
+// Asynchronous engine stages for composite operations. Frames are fetched
+// on a decode executor with its own decoder (through the frame service, so
+// frames other sessions decoded are shared); conversion and reduction run
+// on a compute executor. A composite operation is one linear coroutine
+// that starts fetching the next frame before it converts the current one,
+// so decoding and compute overlap instead of alternating.
+
+// Included after thermal_engine.cpp
+class AsyncEngine {
+private:
+    ThermalEngine& engine;
+
+    // Only used on the decoder executor's thread
+    cv::VideoCapture cap;
+    std::string openPath;
+    int position = -1;  // Frame the next cap.read() returns without seeking
+
+    // Declared after the state their tasks use: the executors are destroyed
+    // first, and their destructors drain queued tasks that still use it
+    Executor decoder{1};
+    Executor compute{std::max(1u, std::thread::hardware_concurrency() / 2)};
+
+    // Loaded video when the operation was started; a video loaded meanwhile
+    // does not change what the operation reads
+    struct Source {
+        std::string path;
+        uint64_t videoKey;
+    };
+
+    Source currentSource() const {
+        return Source{ engine.getVideoPath(), engine.getVideoKey() };
+    }
+
+    Task<Frame> fetchFrame(Source source, int frameNumber) {
+        co_await decoder.schedule();
+
+        if (source.path != openPath) {
+            openPath.clear();
+            position = -1;
+            if (!cap.open(source.path)) {
+                throw std::runtime_error("Could not open video: " + source.path);
+            }
+            openPath = source.path;
+        }
+
+        Frame frame = engine.getFrameService().get(source.videoKey, frameNumber, [&](cv::Mat& decoded) {
+            // Sequential frames continue reading without a seek
+            if (frameNumber != position) {
+                cap.set(cv::CAP_PROP_POS_FRAMES, frameNumber);
+            }
+
+            if (!cap.read(decoded)) {
+                position = -1;
+                return false;
+            }
+
+            position = frameNumber + 1;
+            return true;
+        });
+
+        if (frame.empty()) {
+            throw std::runtime_error("Could not read frame " + std::to_string(frameNumber));
+        }
+        co_return frame;
+    }
+
+    Task<std::vector<float>> convertQueryFrame(std::shared_ptr<const QueryPlan> plan, Frame frame) {
+        co_await compute.schedule();
+
+        std::vector<float> temps;
+        engine.convertQueryFrame(*plan, frame, temps);
+        co_return temps;
+    }
+
+    Task<QueryResult> queryFrames(std::shared_ptr<const QueryPlan> plan, std::vector<int> frames, Source source) {
+        QueryResult result = plan->emptyResult(frames.size());
+
+        // Ascending frames let sequential ones continue without a seek
+        std::vector<size_t> order(frames.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return frames[a] < frames[b]; });
+
+        Task<Frame> next;
+        if (!order.empty()) {
+            next = fetchFrame(source, frames[order[0]]);
+            next.start();
+        }
+
+        std::vector<float> gathered;
+        for (size_t i = 0; i < order.size(); ) {
+            int frameNumber = frames[order[i]];
+            size_t end = i + 1;
+            while (end < order.size() && frames[order[end]] == frameNumber) end++;
+
+            Frame frame;
+            try {
+                frame = co_await next;
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << " for query" << std::endl;
+            }
+
+            // Decode the next frame while this one is converted
+            if (end < order.size()) {
+                next = fetchFrame(source, frames[order[end]]);
+                next.start();
+            }
+
+            // Failures stay inside the loop: the next fetch is running and
+            // must be awaited
+            if (!frame.empty()) {
+                try {
+                    std::vector<float> temps = co_await convertQueryFrame(plan, frame);
+
+                    // Repeated frames reuse the conversion
+                    for (size_t j = i; j < end; j++) {
+                        plan->reduce(temps, order[j], result.outputs, gathered);
+                        result.valid[order[j]] = 1;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "Exception converting frame " << frameNumber << " for query: " << e.what() << std::endl;
+                }
+            }
+            i = end;
+        }
+
+        co_return result;
+    }
+
+public:
+    explicit AsyncEngine(ThermalEngine& thermalEngine) : engine(thermalEngine) {}
+
+    // Cached or decoded frame of the loaded video
+    Task<Frame> fetchFrame(int frameNumber) {
+        return fetchFrame(currentSource(), frameNumber);
+    }
+
+    // Same result as ThermalEngine::runQuery. Call on the thread that loads
+    // videos; the plan must fit the loaded video.
+    Task<QueryResult> runQuery(std::shared_ptr<const QueryPlan> plan, std::vector<int> frames) {
+        return queryFrames(std::move(plan), std::move(frames), currentSource());
+    }
+};
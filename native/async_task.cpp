@@ -0,0 +1,265 @@
+#pragma once
+#include <coroutine>
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <vector>
+
+// C++20 coroutines for composing engine stages. A Task<T> is a lazily
+// started coroutine producing a T; co_await runs it and resumes the awaiting
+// coroutine when it finishes (symmetric transfer, no extra thread hop).
+// Stages move between threads with co_await executor.schedule(), so an
+// operation written as one linear coroutine can decode on one executor and
+// compute on another. start() lets a task run ahead of the coroutine that
+// awaits it later, which is how a pipeline overlaps the next stage's I/O
+// with the current stage's compute.
+
+class TaskPromiseBase {
+public:
+    // Coroutine to resume on completion; done() once the task has finished
+    std::atomic<void*> continuation{nullptr};
+    std::exception_ptr error;
+
+    static void* done() {
+        static char marker;
+        return &marker;
+    }
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            void* waiting = handle.promise().continuation.exchange(done(), std::memory_order_acq_rel);
+            if (waiting != nullptr) {
+                return std::coroutine_handle<>::from_address(waiting);
+            }
+            return std::noop_coroutine();  // Not awaited yet
+        }
+
+        void await_resume() noexcept {}
+    };
+
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept {
+        error = std::current_exception();
+    }
+};
+
+template <typename T> class Task;
+
+template <typename T>
+class TaskPromise : public TaskPromiseBase {
+public:
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+
+    template <typename U>
+    void return_value(U&& result) {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T result() {
+        if (error) std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+class TaskPromise<void> : public TaskPromiseBase {
+public:
+    Task<void> get_return_object();
+
+    void return_void() noexcept {}
+
+    void result() {
+        if (error) std::rethrow_exception(error);
+    }
+};
+
+template <typename T>
+class Task {
+public:
+    using promise_type = TaskPromise<T>;
+
+    Task() = default;
+    explicit Task(std::coroutine_handle<promise_type> coroutine) : handle(coroutine) {}
+
+    Task(Task&& other) noexcept
+        : handle(std::exchange(other.handle, nullptr)), started(other.started) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+            started = other.started;
+        }
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    // A started task must be awaited before it is destroyed
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+    bool valid() const { return static_cast<bool>(handle); }
+
+    // Run now, up to the first suspension, instead of when awaited
+    void start() {
+        if (!started) {
+            started = true;
+            handle.resume();
+        }
+    }
+
+    struct Awaiter {
+        std::coroutine_handle<promise_type> handle;
+        bool& started;
+
+        bool await_ready() noexcept {
+            return started && handle.promise().continuation.load(std::memory_order_acquire) == TaskPromiseBase::done();
+        }
+
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<> waiting) noexcept {
+            if (!started) {
+                started = true;
+                handle.promise().continuation.store(waiting.address(), std::memory_order_relaxed);
+                return handle;
+            }
+
+            // Started earlier: wait for it, unless it finished meanwhile
+            void* expected = nullptr;
+            if (handle.promise().continuation.compare_exchange_strong(expected, waiting.address(),
+                                                                      std::memory_order_acq_rel)) {
+                return std::noop_coroutine();
+            }
+            return waiting;
+        }
+
+        T await_resume() {
+            return handle.promise().result();
+        }
+    };
+
+    Awaiter operator co_await() noexcept {
+        return Awaiter{ handle, started };
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+    bool started = false;
+};
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Fixed set of threads resuming coroutines in FIFO order
+class Executor {
+private:
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::coroutine_handle<>> queue;
+    bool stopping = false;
+
+    void run() {
+        while (true) {
+            std::coroutine_handle<> next;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) return;  // Stopping with nothing left
+
+                next = queue.front();
+                queue.pop_front();
+            }
+            next.resume();
+        }
+    }
+
+public:
+    explicit Executor(size_t threadCount) {
+        for (size_t i = 0; i < std::max<size_t>(threadCount, 1); i++) {
+            threads.emplace_back(&Executor::run, this);
+        }
+    }
+
+    ~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    void post(std::coroutine_handle<> coroutine) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(coroutine);
+        }
+        wake.notify_one();
+    }
+
+    struct ScheduleAwaiter {
+        Executor& executor;
+        bool await_ready() noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> coroutine) { executor.post(coroutine); }
+        void await_resume() noexcept {}
+    };
+
+    // co_await executor.schedule() continues on one of the executor's threads
+    ScheduleAwaiter schedule() {
+        return ScheduleAwaiter{ *this };
+    }
+};
+
+// Coroutine that starts immediately and frees itself when it finishes
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// Run task without an awaiting coroutine. onDone(value, error) is called on
+// the thread that finishes the task, with either the value or the exception.
+template <typename T, typename OnDone>
+Detached spawn(Task<T> task, OnDone onDone) {
+    std::shared_ptr<T> value;
+    std::exception_ptr error;
+    try {
+        value = std::make_shared<T>(co_await task);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    onDone(std::move(value), error);
+}
@@ -0,0 +1,387 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define THERMAL_IO_URING
+#endif
+#endif
+
+// Batched positional reads from one file. All reads of a batch are in
+// flight together, so cold-cache random access keeps the device queue full
+// instead of waiting for one seek at a time:
+//   io_uring     Linux 5.6+: the batch is submitted through one ring with
+//                raw syscalls (no liburing dependency)
+//   threads      elsewhere, or where io_uring is unavailable or blocked
+//                (older kernels, seccomp filters in containers): a pool of
+//                workers with their own file handles reads concurrently
+
+static const unsigned READ_QUEUE_DEPTH = 32;
+
+struct ReadRequest {
+    uint64_t offset = 0;
+    size_t length = 0;
+    uint8_t* buffer = nullptr;
+    bool ok = false;
+};
+
+// Pool of reader threads, each with its own handle on the file
+class ReadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::vector<ReadRequest>* batch = nullptr;
+    size_t nextRequest = 0;
+    size_t doneRequests = 0;
+    bool stopping = false;
+
+    void run(std::string path) {
+        std::ifstream file(path, std::ios::binary);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || (batch && nextRequest < batch->size()); });
+            if (stopping) return;
+
+            ReadRequest& request = (*batch)[nextRequest++];
+            lock.unlock();
+
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(request.offset));
+            request.ok = file.is_open() &&
+                         file.read(reinterpret_cast<char*>(request.buffer), static_cast<std::streamsize>(request.length)).good();
+
+            lock.lock();
+            if (++doneRequests == batch->size()) {
+                finished.notify_all();
+            }
+        }
+    }
+
+public:
+    ~ReadPool() {
+        stop();
+    }
+
+    void start(const std::string& path, size_t threadCount) {
+        stop();
+        stopping = false;
+        for (size_t i = 0; i < threadCount; i++) {
+            workers.emplace_back(&ReadPool::run, this, path);
+        }
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    void read(std::vector<ReadRequest>& requests) {
+        if (requests.empty()) return;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        batch = &requests;
+        nextRequest = 0;
+        doneRequests = 0;
+        wake.notify_all();
+        finished.wait(lock, [&] { return doneRequests == requests.size(); });
+        batch = nullptr;
+    }
+};
+
+#ifdef THERMAL_IO_URING
+// Submission and completion rings of one io_uring instance
+class IoUring {
+private:
+    int ringFd = -1;
+    unsigned entries = 0;
+
+    void* sqRing = MAP_FAILED;
+    void* cqRing = MAP_FAILED;
+    size_t sqRingBytes = 0;
+    size_t cqRingBytes = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesBytes = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    // Completion result that means the kernel has no IORING_OP_READ
+    static bool unsupported(int result) {
+        return result == -EINVAL || result == -EOPNOTSUPP;
+    }
+
+public:
+    ~IoUring() {
+        close();
+    }
+
+    bool init(unsigned depth) {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+        if (ringFd < 0) return false;
+
+        entries = params.sq_entries;
+        sqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            sqRingBytes = cqRingBytes = std::max(sqRingBytes, cqRingBytes);
+        }
+
+        sqRing = mmap(nullptr, sqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            close();
+            return false;
+        }
+        cqRing = singleMap ? sqRing
+                           : mmap(nullptr, cqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        sqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                               ringFd, IORING_OFF_SQES));
+        if (cqRing == MAP_FAILED || sqes == MAP_FAILED) {
+            close();
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    void close() {
+        if (sqes != MAP_FAILED) munmap(sqes, sqesBytes);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingBytes);
+        if (sqRing != MAP_FAILED) munmap(sqRing, sqRingBytes);
+        sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+        sqRing = cqRing = MAP_FAILED;
+        if (ringFd >= 0) ::close(ringFd);
+        ringFd = -1;
+    }
+
+    // Read every request from fd; short reads are resubmitted for the rest.
+    // False if the ring cannot be used (no IORING_OP_READ before Linux 5.6,
+    // or io_uring_enter failed): requests that did not complete are left
+    // for another backend.
+    bool read(int fd, std::vector<ReadRequest>& requests) {
+        std::vector<size_t> transferred(requests.size(), 0);
+        std::deque<size_t> queue;
+        for (size_t i = 0; i < requests.size(); i++) {
+            requests[i].ok = requests[i].length == 0;
+            if (!requests[i].ok) queue.push_back(i);
+        }
+
+        unsigned tail = *sqTail;
+        size_t inFlight = 0;
+        bool usable = true;
+
+        while (!queue.empty() || inFlight > 0) {
+            // Queue as many reads as the ring holds
+            while (!queue.empty() && inFlight < entries) {
+                size_t index = queue.front();
+                queue.pop_front();
+                ReadRequest& request = requests[index];
+
+                unsigned slot = tail & *sqMask;
+                io_uring_sqe& sqe = sqes[slot];
+                std::memset(&sqe, 0, sizeof(sqe));
+                sqe.opcode = IORING_OP_READ;
+                sqe.fd = fd;
+                sqe.off = request.offset + transferred[index];
+                sqe.addr = reinterpret_cast<uint64_t>(request.buffer + transferred[index]);
+                sqe.len = static_cast<uint32_t>(std::min<size_t>(request.length - transferred[index], 1u << 30));
+                sqe.user_data = index;
+                sqArray[slot] = slot;
+                tail++;
+                inFlight++;
+            }
+            __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+
+            unsigned unsubmitted = tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            int submitted = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, unsubmitted, 1,
+                                                     IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (submitted < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                // Withdraw what the kernel has not taken; submitted reads
+                // still land in their buffers and are waited for
+                tail -= unsubmitted;
+                __atomic_store_n(sqTail, tail, __ATOMIC_RELEASE);
+                inFlight -= unsubmitted;
+                queue.clear();
+                usable = false;
+                if (inFlight == 0) break;
+            }
+
+            unsigned head = *cqHead;
+            unsigned completed = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+            for (; head != completed; head++) {
+                const io_uring_cqe& cqe = cqes[head & *cqMask];
+                size_t index = static_cast<size_t>(cqe.user_data);
+                inFlight--;
+
+                if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+                    queue.push_back(index);
+                } else if (cqe.res <= 0) {
+                    if (unsupported(cqe.res)) usable = false;
+                } else {
+                    transferred[index] += static_cast<size_t>(cqe.res);
+                    if (transferred[index] < requests[index].length) {
+                        queue.push_back(index);
+                    } else {
+                        requests[index].ok = true;
+                    }
+                }
+            }
+            __atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+
+            if (!usable) queue.clear();
+        }
+
+        return usable;
+    }
+};
+#endif
+
+// Not thread-safe: one batch at a time (callers hold their own lock)
+class BatchReader {
+private:
+    ReadPool pool;
+    bool poolRunning = false;
+    std::string path;
+    bool opened = false;
+#ifdef THERMAL_IO_URING
+    std::unique_ptr<IoUring> ring;
+    int fd = -1;
+#endif
+
+    void startPool() {
+        if (!poolRunning) {
+            pool.start(path, std::max(4u, std::min(READ_QUEUE_DEPTH, std::thread::hardware_concurrency() * 2)));
+            poolRunning = true;
+        }
+    }
+
+public:
+    ~BatchReader() {
+        close();
+    }
+
+    bool open(const std::string& filePath) {
+        close();
+        path = filePath;
+
+        std::ifstream probe(filePath, std::ios::binary);
+        if (!probe.is_open()) return false;
+        opened = true;
+
+#ifdef THERMAL_IO_URING
+        fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+        ring.reset(new IoUring());
+        if (fd >= 0 && ring->init(READ_QUEUE_DEPTH)) {
+            return true;
+        }
+        ring.reset();
+#endif
+        startPool();
+        return true;
+    }
+
+    void close() {
+        pool.stop();
+        poolRunning = false;
+#ifdef THERMAL_IO_URING
+        ring.reset();
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+#endif
+        opened = false;
+    }
+
+    bool isOpen() const { return opened; }
+
+    const char* backend() const {
+#ifdef THERMAL_IO_URING
+        if (ring) return "io_uring";
+#endif
+        return "threads";
+    }
+
+    // Fill every request; false if any of them failed (see ReadRequest::ok)
+    bool read(std::vector<ReadRequest>& requests) {
+        if (!opened) return false;
+
+        auto allRead = [&requests] {
+            return std::all_of(requests.begin(), requests.end(), [](const ReadRequest& r) { return r.ok; });
+        };
+
+#ifdef THERMAL_IO_URING
+        if (ring) {
+            if (ring->read(fd, requests)) {
+                return allRead();
+            }
+
+            std::cerr << "Warning: io_uring reads failed, using reader threads" << std::endl;
+            ring.reset();
+            startPool();
+
+            // Retry what the ring did not read
+            std::vector<ReadRequest> rest;
+            std::vector<size_t> indices;
+            for (size_t i = 0; i < requests.size(); i++) {
+                if (!requests[i].ok) {
+                    rest.push_back(requests[i]);
+                    indices.push_back(i);
+                }
+            }
+            pool.read(rest);
+            for (size_t i = 0; i < rest.size(); i++) {
+                requests[indices[i]].ok = rest[i].ok;
+            }
+            return allRead();
+        }
+#endif
+        pool.read(requests);
+        return allRead();
+    }
+};
@@ -1,117 +1,1708 @@
 #include <napi.h>
 #include "thermal_engine.cpp"  // Include the thermal engine
+#include "live_capture.cpp"    // Live capture pipeline on top of the engine
+#include "profile_codec.cpp"   // Delta compression of streamed profiles
+#include "frame_broadcast.cpp"  // Shared review playback for many viewers
+#include "async_engine.cpp"     // Coroutine stages settled as Promises
 #include <iostream>
+#include <cmath>
+#include <limits>
 
 // Global engine instance
 static ThermalEngine engine;
 
+// Live capture pipeline and the JS callback receiving its results
+static LiveCapture liveCapture(engine);
+static Napi::ThreadSafeFunction liveCallback;
+static bool liveCallbackActive = false;
+static uint32_t liveGeneration = 0;           // Capture runs started; JS thread only
+static std::atomic<int> liveQueued{0};        // Results queued on liveCallback
+static const int MAX_QUEUED_LIVE_RESULTS = 2;
+
+// Shared review playback and the JS callback receiving every subscriber's results
+static FrameBroadcast broadcast(engine);
+static Napi::ThreadSafeFunction broadcastCallback;
+static bool broadcastCallbackActive = false;
+static uint32_t broadcastGeneration = 0;     // Broadcasts started; JS thread only
+static std::atomic<size_t> broadcastQueued{0};
+
+// Decode and compute executors of the Promise-returning functions
+static AsyncEngine asyncEngine(engine);
+
+// Most lines accepted by one analyzeLines call
+static const size_t MAX_BATCH_LINES = 256;
+
 // Helper function to validate and extract number parameters
 double GetNumberParam(const Napi::CallbackInfo& info, int index, const std::string& paramName) {
     if (info.Length() <= index || !info[index].IsNumber()) {
         throw Napi::TypeError::New(info.Env(), paramName + " must be a number");
     }
-    return info[index].As<Napi::Number>().DoubleValue();
+    return info[index].As<Napi::Number>().DoubleValue();
+}
+
+// Integer parameters: NaN and infinities are rejected, other values are
+// truncated and saturated to the int range (casting them directly is
+// undefined behaviour)
+int GetIntParam(const Napi::CallbackInfo& info, int index, const std::string& paramName) {
+    double value = GetNumberParam(info, index, paramName);
+    if (!std::isfinite(value)) {
+        throw Napi::RangeError::New(info.Env(), paramName + " must be a finite number");
+    }
+    value = std::max(value, static_cast<double>(std::numeric_limits<int>::min()));
+    value = std::min(value, static_cast<double>(std::numeric_limits<int>::max()));
+    return static_cast<int>(value);
+}
+
+// Helper function to validate and extract string parameters
+std::string GetStringParam(const Napi::CallbackInfo& info, int index, const std::string& paramName) {
+    if (info.Length() <= index || !info[index].IsString()) {
+        throw Napi::TypeError::New(info.Env(), paramName + " must be a string");
+    }
+    return info[index].As<Napi::String>().Utf8Value();
+}
+
+// Helper function to read a temperature format name ("f32", "f16", "u16")
+TempFormat GetTempFormat(Napi::Env env, const Napi::Value& value, const std::string& paramName) {
+    TempFormat format;
+    if (!value.IsString() || !parseTempFormat(value.As<Napi::String>().Utf8Value(), format)) {
+        throw Napi::TypeError::New(env, paramName + " must be 'f32', 'f16' or 'u16'");
+    }
+    return format;
+}
+
+// Load video file
+Napi::Value LoadVideo(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters
+        if (info.Length() < 1) {
+            throw Napi::TypeError::New(env, "Expected 1 argument: video path");
+        }
+        
+        std::string videoPath = GetStringParam(info, 0, "videoPath");
+        
+        // A broadcast plays the current video; stop it before replacing it
+        broadcast.stop();
+        
+        // Load video
+        bool success = engine.loadVideo(videoPath);
+        
+        if (success) {
+            std::cout << "Video loaded successfully via Node.js binding" << std::endl;
+        } else {
+            std::cout << "Failed to load video via Node.js binding" << std::endl;
+        }
+        
+        return Napi::Boolean::New(env, success);
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error loading video: ") + e.what());
+    }
+}
+
+// Load temperature mapping CSV
+Napi::Value LoadTempMapping(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters
+        if (info.Length() < 1) {
+            throw Napi::TypeError::New(env, "Expected 1 argument: CSV path");
+        }
+        
+        std::string csvPath = GetStringParam(info, 0, "csvPath");
+        
+        // Load temperature mapping
+        bool success = engine.loadTempMapping(csvPath);
+        
+        if (success) {
+            std::cout << "Temperature mapping loaded successfully via Node.js binding" << std::endl;
+        } else {
+            std::cout << "Failed to load temperature mapping via Node.js binding" << std::endl;
+        }
+        
+        return Napi::Boolean::New(env, success);
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error loading temperature mapping: ") + e.what());
+    }
+}
+
+// Analyze temperature along a line
+Napi::Value AnalyzeLine(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: frameNum, x1, y1, x2, y2, [level]
+        if (info.Length() < 5) {
+            throw Napi::TypeError::New(env, "Expected 5 arguments: frameNum, x1, y1, x2, y2");
+        }
+        
+        int frameNum = GetIntParam(info, 0, "frameNum");
+        int x1 = GetIntParam(info, 1, "x1");
+        int y1 = GetIntParam(info, 2, "y1");
+        int x2 = GetIntParam(info, 3, "x2");
+        int y2 = GetIntParam(info, 4, "y2");
+        int level = info.Length() > 5 ? GetIntParam(info, 5, "level") : 0;
+        
+        // Validate pyramid level
+        if (level < 0 || level > 4) {
+            throw Napi::RangeError::New(env, "Pyramid level must be between 0 and 4");
+        }
+        
+        // Validate frame number
+        if (frameNum < 0 || frameNum >= engine.getTotalFrames()) {
+            throw Napi::RangeError::New(env, "Frame number out of range");
+        }
+        
+        // Analyze line
+        std::vector<float> temperatures = engine.analyzeLine(frameNum, x1, y1, x2, y2, level);
+        
+        // Convert std::vector<float> to Napi::Array
+        Napi::Array result = Napi::Array::New(env, temperatures.size());
+        
+        for (size_t i = 0; i < temperatures.size(); i++) {
+            result[i] = Napi::Number::New(env, temperatures[i]);
+        }
+        
+        return result;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error analyzing line: ") + e.what());
+    }
+}
+
+// Helper function to read numbers (temperatures, points) from an Array or Float32Array
+std::vector<float> GetFloatArray(Napi::Env env, const Napi::Value& value, const std::string& paramName) {
+    std::vector<float> temperatures;
+    
+    if (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_float32_array) {
+        Napi::Float32Array array = value.As<Napi::Float32Array>();
+        temperatures.assign(array.Data(), array.Data() + array.ElementLength());
+    } else if (value.IsArray()) {
+        Napi::Array array = value.As<Napi::Array>();
+        temperatures.resize(array.Length());
+        for (uint32_t i = 0; i < array.Length(); i++) {
+            Napi::Value item = array[i];
+            temperatures[i] = item.IsNumber() ? item.As<Napi::Number>().FloatValue() : 0.0f;
+        }
+    } else {
+        throw Napi::TypeError::New(env, paramName + " must be an Array or Float32Array");
+    }
+    
+    return temperatures;
+}
+
+// Encode temperatures (Array or Float32Array) into a compact Buffer for transport
+Napi::Value EncodeTemperatures(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: temperatures, format
+        if (info.Length() < 2) {
+            throw Napi::TypeError::New(env, "Expected 2 arguments: temperatures, format");
+        }
+        
+        TempFormat format = GetTempFormat(env, info[1], "format");
+        std::vector<float> temperatures = GetFloatArray(env, info[0], "temperatures");
+        
+        Napi::Buffer<uint8_t> buffer = Napi::Buffer<uint8_t>::New(env, temperatures.size() * tempFormatBytes(format));
+        encodeTemperatures(temperatures.data(), temperatures.size(), format, buffer.Data());
+        return buffer;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error encoding temperatures: ") + e.what());
+    }
+}
+
+// Delta-compress a profile against the previous one of the same stream.
+// Returns { data, quantized, key }; pass quantized as previous next time.
+Napi::Value EncodeProfile(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: temperatures, [previous]
+        if (info.Length() < 1) {
+            throw Napi::TypeError::New(env, "Expected arguments: temperatures, [previous]");
+        }
+        
+        std::vector<float> temperatures = GetFloatArray(env, info[0], "temperatures");
+        
+        const uint16_t* previous = nullptr;
+        size_t previousCount = 0;
+        if (info.Length() > 1 && info[1].IsBuffer()) {
+            Napi::Buffer<uint8_t> previousBuffer = info[1].As<Napi::Buffer<uint8_t>>();
+            previous = reinterpret_cast<const uint16_t*>(previousBuffer.Data());
+            previousCount = previousBuffer.Length() / sizeof(uint16_t);
+        }
+        
+        Napi::Buffer<uint8_t> quantized = Napi::Buffer<uint8_t>::New(env, temperatures.size() * sizeof(uint16_t));
+        uint16_t* current = reinterpret_cast<uint16_t*>(quantized.Data());
+        encodeTemperatures(temperatures.data(), temperatures.size(), TempFormat::U16_DECI, current);
+        
+        std::vector<uint8_t> encoded = profilecodec::encode(current, temperatures.size(), previous, previousCount);
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("data", Napi::Buffer<uint8_t>::Copy(env, encoded.data(), encoded.size()));
+        result.Set("quantized", quantized);
+        result.Set("key", Napi::Boolean::New(env, encoded[0] == profilecodec::PROFILE_KEY));
+        return result;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error encoding profile: ") + e.what());
+    }
+}
+
+// Helper function to read a {x1, y1, x2, y2} object into a line segment
+LineSegment GetLineObject(Napi::Env env, const Napi::Value& value, const std::string& paramName) {
+    if (!value.IsObject()) {
+        throw Napi::TypeError::New(env, paramName + " must be an object with x1, y1, x2, y2");
+    }
+    
+    Napi::Object obj = value.As<Napi::Object>();
+    const char* keys[4] = { "x1", "y1", "x2", "y2" };
+    int coords[4];
+    
+    for (int i = 0; i < 4; i++) {
+        Napi::Value coord = obj.Get(keys[i]);
+        if (!coord.IsNumber()) {
+            throw Napi::TypeError::New(env, paramName + "." + keys[i] + " must be a number");
+        }
+        coords[i] = static_cast<int>(coord.As<Napi::Number>().DoubleValue());
+    }
+    
+    return { coords[0], coords[1], coords[2], coords[3] };
+}
+
+// Helper function to read a {x, y, width, height} object into a region
+RegionSpec GetRegionObject(Napi::Env env, const Napi::Value& value, const std::string& paramName) {
+    if (!value.IsObject()) {
+        throw Napi::TypeError::New(env, paramName + " must be an object with x, y, width, height");
+    }
+    
+    Napi::Object obj = value.As<Napi::Object>();
+    const char* keys[4] = { "x", "y", "width", "height" };
+    int fields[4];
+    
+    for (int i = 0; i < 4; i++) {
+        Napi::Value field = obj.Get(keys[i]);
+        if (!field.IsNumber()) {
+            throw Napi::TypeError::New(env, paramName + "." + keys[i] + " must be a number");
+        }
+        fields[i] = static_cast<int>(field.As<Napi::Number>().DoubleValue());
+    }
+    
+    return { fields[0], fields[1], fields[2], fields[3] };
+}
+
+// Helper function to read an alarm rule object, e.g.
+// { id, source: 'roi', index: 0, metric: 'max', op: '>', threshold: 1450, frames: 5 } or
+// { id, source: 'line', index: 0, metric: 'coolingRate', of: 'max', band: [800, 500], op: '<', threshold: 150 }
+AlarmRule GetAlarmRule(Napi::Env env, const Napi::Value& value, const std::string& paramName) {
+    if (!value.IsObject()) {
+        throw Napi::TypeError::New(env, paramName + " must be an object");
+    }
+    
+    Napi::Object obj = value.As<Napi::Object>();
+    AlarmRule rule;
+    
+    auto getMetric = [&](const std::string& name, bool allowRate) {
+        if (name == "min") return AlarmMetric::MIN;
+        if (name == "max") return AlarmMetric::MAX;
+        if (name == "avg") return AlarmMetric::AVG;
+        if (name == "coolingRate" && allowRate) return AlarmMetric::COOLING_RATE;
+        throw Napi::TypeError::New(env, paramName + " has unknown metric: " + name);
+    };
+    
+    if (!obj.Get("id").IsString() || !obj.Get("source").IsString() || !obj.Get("metric").IsString() ||
+        !obj.Get("op").IsString() || !obj.Get("index").IsNumber() || !obj.Get("threshold").IsNumber()) {
+        throw Napi::TypeError::New(env, paramName + " needs id, source, index, metric, op and threshold");
+    }
+    
+    rule.id = obj.Get("id").As<Napi::String>().Utf8Value();
+    
+    std::string source = obj.Get("source").As<Napi::String>().Utf8Value();
+    if (source != "line" && source != "roi") {
+        throw Napi::TypeError::New(env, paramName + ".source must be 'line' or 'roi'");
+    }
+    rule.source = source == "line" ? AlarmSource::LINE : AlarmSource::ROI;
+    rule.index = obj.Get("index").As<Napi::Number>().Int32Value();
+    rule.metric = getMetric(obj.Get("metric").As<Napi::String>().Utf8Value(), true);
+    
+    std::string op = obj.Get("op").As<Napi::String>().Utf8Value();
+    if (op != ">" && op != "<") {
+        throw Napi::TypeError::New(env, paramName + ".op must be '>' or '<'");
+    }
+    rule.op = op == ">" ? AlarmOp::GREATER : AlarmOp::LESS;
+    rule.threshold = obj.Get("threshold").As<Napi::Number>().FloatValue();
+    
+    if (obj.Get("frames").IsNumber()) {
+        rule.frames = obj.Get("frames").As<Napi::Number>().Int32Value();
+    }
+    
+    if (rule.metric == AlarmMetric::COOLING_RATE) {
+        if (obj.Get("of").IsString()) {
+            rule.rateOf = getMetric(obj.Get("of").As<Napi::String>().Utf8Value(), false);
+        }
+        if (obj.Get("band").IsArray()) {
+            Napi::Array band = obj.Get("band").As<Napi::Array>();
+            Napi::Value high = band[0u];
+            Napi::Value low = band[1u];
+            if (band.Length() != 2 || !high.IsNumber() || !low.IsNumber()) {
+                throw Napi::TypeError::New(env, paramName + ".band must be [high, low]");
+            }
+            rule.bandHigh = high.As<Napi::Number>().FloatValue();
+            rule.bandLow = low.As<Napi::Number>().FloatValue();
+        }
+    }
+    
+    return rule;
+}
+
+// Helper function to read { lines: [...], rois: [...], rules: [...] } into a live configuration
+LiveConfig GetLiveConfig(Napi::Env env, const Napi::Object& options) {
+    LiveConfig config;
+    
+    if (options.Get("lines").IsArray()) {
+        Napi::Array lines = options.Get("lines").As<Napi::Array>();
+        for (uint32_t i = 0; i < lines.Length(); i++) {
+            config.lines.push_back(GetLineObject(env, lines[i], "lines[" + std::to_string(i) + "]"));
+        }
+    }
+    
+    if (options.Get("rois").IsArray()) {
+        Napi::Array rois = options.Get("rois").As<Napi::Array>();
+        for (uint32_t i = 0; i < rois.Length(); i++) {
+            config.regions.push_back(GetRegionObject(env, rois[i], "rois[" + std::to_string(i) + "]"));
+        }
+    }
+    
+    if (options.Get("rules").IsArray()) {
+        Napi::Array rules = options.Get("rules").As<Napi::Array>();
+        for (uint32_t i = 0; i < rules.Length(); i++) {
+            config.rules.push_back(GetAlarmRule(env, rules[i], "rules[" + std::to_string(i) + "]"));
+        }
+        
+        // Reject rules that point at geometry that does not exist
+        AlarmPlan plan;
+        std::string error = plan.compile(config.rules, config.lines.size(), config.regions.size());
+        if (!error.empty()) {
+            throw Napi::RangeError::New(env, error);
+        }
+    }
+    
+    return config;
+}
+
+// Helper function to read a query:
+// { geometries: [{ type: 'point', x, y } | { type: 'line', x1, y1, x2, y2 } |
+//                { type: 'path', points, smooth, spacing } | { type: 'region', x, y, width, height }],
+//   outputs: [{ geometry, reduce: 'profile' | 'stats' | 'histogram' | 'kymograph',
+//               bins, range: [low, high], width }],
+//   level }
+QuerySpec GetQuerySpec(Napi::Env env, const Napi::Object& query) {
+    QuerySpec spec;
+    
+    auto checkCoord = [&](double value, const std::string& name) {
+        if (!std::isfinite(value) || std::fabs(value) > LINE_COORD_LIMIT) {
+            throw Napi::RangeError::New(env, name + " must be a finite pixel coordinate");
+        }
+        return static_cast<int>(value);
+    };
+    
+    if (!query.Get("geometries").IsArray() || !query.Get("outputs").IsArray()) {
+        throw Napi::TypeError::New(env, "query needs geometries and outputs arrays");
+    }
+    
+    Napi::Array geometries = query.Get("geometries").As<Napi::Array>();
+    if (geometries.Length() > MAX_QUERY_GEOMETRIES) {
+        throw Napi::RangeError::New(env, "At most " + std::to_string(MAX_QUERY_GEOMETRIES) + " geometries per query");
+    }
+    
+    for (uint32_t i = 0; i < geometries.Length(); i++) {
+        std::string name = "geometries[" + std::to_string(i) + "]";
+        Napi::Value value = geometries[i];
+        if (!value.IsObject() || !value.As<Napi::Object>().Get("type").IsString()) {
+            throw Napi::TypeError::New(env, name + " must be an object with a type");
+        }
+        
+        Napi::Object obj = value.As<Napi::Object>();
+        std::string type = obj.Get("type").As<Napi::String>().Utf8Value();
+        QueryGeometry geometry;
+        
+        if (type == "point") {
+            if (!obj.Get("x").IsNumber() || !obj.Get("y").IsNumber()) {
+                throw Napi::TypeError::New(env, name + " needs numeric x and y");
+            }
+            geometry.type = QueryGeometryType::POINT;
+            geometry.line.x1 = checkCoord(obj.Get("x").As<Napi::Number>().DoubleValue(), name + ".x");
+            geometry.line.y1 = checkCoord(obj.Get("y").As<Napi::Number>().DoubleValue(), name + ".y");
+        } else if (type == "line") {
+            geometry.type = QueryGeometryType::LINE;
+            geometry.line = GetLineObject(env, obj, name);
+            checkCoord(geometry.line.x1, name + ".x1");
+            checkCoord(geometry.line.y1, name + ".y1");
+            checkCoord(geometry.line.x2, name + ".x2");
+            checkCoord(geometry.line.y2, name + ".y2");
+        } else if (type == "path") {
+            geometry.type = QueryGeometryType::PATH;
+            geometry.path.points = GetFloatArray(env, obj.Get("points"), name + ".points");
+            if (obj.Get("smooth").IsBoolean()) {
+                geometry.path.smooth = obj.Get("smooth").As<Napi::Boolean>().Value();
+            }
+            if (obj.Get("spacing").IsNumber()) {
+                geometry.path.spacing = obj.Get("spacing").As<Napi::Number>().FloatValue();
+            }
+            const PathSpec& path = geometry.path;
+            if (path.points.size() < 2 || path.points.size() % 2 != 0 || path.pointCount() > MAX_PATH_POINTS) {
+                throw Napi::RangeError::New(env, name + ".points must hold 1 to " + std::to_string(MAX_PATH_POINTS) + " x, y pairs");
+            }
+            for (float point : path.points) {
+                checkCoord(point, name + ".points");
+            }
+            if (!(path.spacing >= 0.25f && path.spacing <= 1024.0f)) {
+                throw Napi::RangeError::New(env, name + ".spacing must be between 0.25 and 1024 pixels");
+            }
+        } else if (type == "region") {
+            geometry.type = QueryGeometryType::REGION;
+            geometry.region = GetRegionObject(env, obj, name);
+            checkCoord(geometry.region.x, name + ".x");
+            checkCoord(geometry.region.y, name + ".y");
+            checkCoord(geometry.region.width, name + ".width");
+            checkCoord(geometry.region.height, name + ".height");
+        } else {
+            throw Napi::TypeError::New(env, name + " has unknown type: " + type);
+        }
+        
+        spec.geometries.push_back(std::move(geometry));
+    }
+    
+    Napi::Array outputs = query.Get("outputs").As<Napi::Array>();
+    if (outputs.Length() > MAX_QUERY_OUTPUTS) {
+        throw Napi::RangeError::New(env, "At most " + std::to_string(MAX_QUERY_OUTPUTS) + " outputs per query");
+    }
+    
+    for (uint32_t i = 0; i < outputs.Length(); i++) {
+        std::string name = "outputs[" + std::to_string(i) + "]";
+        Napi::Value value = outputs[i];
+        if (!value.IsObject()) {
+            throw Napi::TypeError::New(env, name + " must be an object");
+        }
+        
+        Napi::Object obj = value.As<Napi::Object>();
+        if (!obj.Get("geometry").IsNumber() || !obj.Get("reduce").IsString()) {
+            throw Napi::TypeError::New(env, name + " needs geometry and reduce");
+        }
+        
+        QueryOutput output;
+        output.geometry = obj.Get("geometry").As<Napi::Number>().Int32Value();
+        
+        std::string reduce = obj.Get("reduce").As<Napi::String>().Utf8Value();
+        if (reduce == "profile") {
+            output.reducer = QueryReducer::PROFILE;
+        } else if (reduce == "stats") {
+            output.reducer = QueryReducer::STATS;
+        } else if (reduce == "histogram") {
+            output.reducer = QueryReducer::HISTOGRAM;
+        } else if (reduce == "kymograph") {
+            output.reducer = QueryReducer::KYMOGRAPH;
+        } else {
+            throw Napi::TypeError::New(env, name + " has unknown reducer: " + reduce);
+        }
+        
+        if (obj.Get("bins").IsNumber()) {
+            output.bins = obj.Get("bins").As<Napi::Number>().Int32Value();
+        }
+        if (obj.Get("range").IsArray()) {
+            Napi::Array range = obj.Get("range").As<Napi::Array>();
+            Napi::Value low = range[0u];
+            Napi::Value high = range[1u];
+            if (range.Length() != 2 || !low.IsNumber() || !high.IsNumber()) {
+                throw Napi::TypeError::New(env, name + ".range must be [low, high]");
+            }
+            output.low = low.As<Napi::Number>().FloatValue();
+            output.high = high.As<Napi::Number>().FloatValue();
+        }
+        if (obj.Get("width").IsNumber()) {
+            output.width = obj.Get("width").As<Napi::Number>().Int32Value();
+        }
+        
+        spec.outputs.push_back(output);
+    }
+    
+    if (query.Get("level").IsNumber()) {
+        spec.level = query.Get("level").As<Napi::Number>().Int32Value();
+    }
+    if (spec.level < 0 || spec.level > 4) {
+        throw Napi::RangeError::New(env, "Pyramid level must be between 0 and 4");
+    }
+    
+    return spec;
+}
+
+// Helper function to read the frames a query runs on:
+// frameNum | [frameNum, ...] | { start, end, step } (end inclusive)
+std::vector<int> GetQueryFrames(Napi::Env env, const Napi::Value& frames, size_t maxFrames) {
+    std::vector<int> list;
+    int totalFrames = engine.getTotalFrames();
+    std::string tooMany = "At most " + std::to_string(maxFrames) + " frames for this query";
+    
+    if (frames.IsNumber()) {
+        list.push_back(frames.As<Napi::Number>().Int32Value());
+    } else if (frames.IsArray()) {
+        Napi::Array array = frames.As<Napi::Array>();
+        if (array.Length() > maxFrames) {
+            throw Napi::RangeError::New(env, tooMany);
+        }
+        for (uint32_t i = 0; i < array.Length(); i++) {
+            Napi::Value frame = array[i];
+            if (!frame.IsNumber()) {
+                throw Napi::TypeError::New(env, "frames[" + std::to_string(i) + "] must be a number");
+            }
+            list.push_back(frame.As<Napi::Number>().Int32Value());
+        }
+    } else if (frames.IsObject()) {
+        Napi::Object range = frames.As<Napi::Object>();
+        if (!range.Get("start").IsNumber()) {
+            throw Napi::TypeError::New(env, "frames.start must be a number");
+        }
+        int start = range.Get("start").As<Napi::Number>().Int32Value();
+        int end = range.Get("end").IsNumber() ? range.Get("end").As<Napi::Number>().Int32Value() : start;
+        int step = range.Get("step").IsNumber() ? range.Get("step").As<Napi::Number>().Int32Value() : 1;
+        if (step <= 0) {
+            throw Napi::RangeError::New(env, "frames.step must be positive");
+        }
+        if (end >= start && (static_cast<int64_t>(end) - start) / step >= static_cast<int64_t>(maxFrames)) {
+            throw Napi::RangeError::New(env, tooMany);
+        }
+        for (int64_t frame = start; frame <= end; frame += step) {
+            list.push_back(static_cast<int>(frame));
+        }
+    } else {
+        throw Napi::TypeError::New(env, "frames must be a number, an array or { start, end, step }");
+    }
+    
+    for (int frame : list) {
+        if (frame < 0 || frame >= totalFrames) {
+            throw Napi::RangeError::New(env, "Frame number out of range: " + std::to_string(frame));
+        }
+    }
+    
+    return list;
+}
+
+// Convert region statistics to a JS object
+Napi::Object StatsToObject(Napi::Env env, const RegionStats& stats) {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("avg", Napi::Number::New(env, stats.avg));
+    result.Set("max", Napi::Number::New(env, stats.max));
+    result.Set("min", Napi::Number::New(env, stats.min));
+    result.Set("count", Napi::Number::New(env, stats.count));
+    return result;
+}
+
+// Convert a bucketed profile to { length, min, max, avg, stats }
+Napi::Object BucketsToObject(Napi::Env env, const ProfileBuckets& profile) {
+    size_t count = profile.buckets.size();
+    Napi::Float32Array minArray = Napi::Float32Array::New(env, count);
+    Napi::Float32Array maxArray = Napi::Float32Array::New(env, count);
+    Napi::Float32Array avgArray = Napi::Float32Array::New(env, count);
+    
+    for (size_t i = 0; i < count; i++) {
+        minArray[i] = profile.buckets[i].min;
+        maxArray[i] = profile.buckets[i].max;
+        avgArray[i] = profile.buckets[i].avg;
+    }
+    
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("length", Napi::Number::New(env, static_cast<double>(profile.length)));
+    result.Set("min", minArray);
+    result.Set("max", maxArray);
+    result.Set("avg", avgArray);
+    result.Set("stats", StatsToObject(env, profile.total));
+    return result;
+}
+
+// Analyze a line reduced to buckets (min/max/avg per bucket), for charts
+// that cannot show more than one sample per pixel column
+Napi::Value AnalyzeLineBuckets(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: frameNum, x1, y1, x2, y2, level, buckets
+        if (info.Length() < 7) {
+            throw Napi::TypeError::New(env, "Expected 7 arguments: frameNum, x1, y1, x2, y2, level, buckets");
+        }
+        
+        int frameNum = GetIntParam(info, 0, "frameNum");
+        int x1 = GetIntParam(info, 1, "x1");
+        int y1 = GetIntParam(info, 2, "y1");
+        int x2 = GetIntParam(info, 3, "x2");
+        int y2 = GetIntParam(info, 4, "y2");
+        int level = GetIntParam(info, 5, "level");
+        int buckets = GetIntParam(info, 6, "buckets");
+        
+        if (level < 0 || level > 4) {
+            throw Napi::RangeError::New(env, "Pyramid level must be between 0 and 4");
+        }
+        
+        if (buckets < 1 || buckets > 8192) {
+            throw Napi::RangeError::New(env, "Bucket count must be between 1 and 8192");
+        }
+        
+        if (frameNum < 0 || frameNum >= engine.getTotalFrames()) {
+            throw Napi::RangeError::New(env, "Frame number out of range");
+        }
+        
+        return BucketsToObject(env, engine.analyzeLineBuckets(frameNum, x1, y1, x2, y2, level, buckets));
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error analyzing line buckets: ") + e.what());
+    }
+}
+
+// Analyze a batch of lines of one frame. lines is an Int32Array of packed
+// x1, y1, x2, y2 quadruples; lines are clipped to the frame natively, so
+// coordinates need no validation or clamping in JS. Returns one Float32Array
+// per line, or one bucket object per line when buckets > 0. A non-zero
+// session reuses that session's converted pixels (release with
+// releaseSession).
+Napi::Value AnalyzeLines(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: frameNum, lines, [level], [buckets], [session]
+        if (info.Length() < 2) {
+            throw Napi::TypeError::New(env, "Expected at least 2 arguments: frameNum, lines");
+        }
+        
+        int frameNum = GetIntParam(info, 0, "frameNum");
+        int level = info.Length() > 2 ? GetIntParam(info, 2, "level") : 0;
+        int buckets = info.Length() > 3 ? GetIntParam(info, 3, "buckets") : 0;
+        uint32_t session = info.Length() > 4 ? static_cast<uint32_t>(GetNumberParam(info, 4, "session")) : 0;
+        
+        if (!info[1].IsTypedArray() || info[1].As<Napi::TypedArray>().TypedArrayType() != napi_int32_array) {
+            throw Napi::TypeError::New(env, "lines must be an Int32Array of x1, y1, x2, y2 values");
+        }
+        
+        Napi::Int32Array packed = info[1].As<Napi::Int32Array>();
+        if (packed.ElementLength() == 0 || packed.ElementLength() % 4 != 0 || packed.ElementLength() / 4 > MAX_BATCH_LINES) {
+            throw Napi::RangeError::New(env, "lines must hold 1 to " + std::to_string(MAX_BATCH_LINES) + " lines of 4 values");
+        }
+        
+        if (level < 0 || level > 4) {
+            throw Napi::RangeError::New(env, "Pyramid level must be between 0 and 4");
+        }
+        
+        if (buckets < 0 || buckets > 8192) {
+            throw Napi::RangeError::New(env, "Bucket count must be between 0 and 8192");
+        }
+        
+        if (frameNum < 0 || frameNum >= engine.getTotalFrames()) {
+            throw Napi::RangeError::New(env, "Frame number out of range");
+        }
+        
+        std::vector<LineSegment> lines(packed.ElementLength() / 4);
+        const int32_t* values = packed.Data();
+        for (size_t i = 0; i < lines.size(); i++) {
+            lines[i] = LineSegment{ values[i * 4], values[i * 4 + 1], values[i * 4 + 2], values[i * 4 + 3] };
+        }
+        
+        std::vector<std::vector<float>> profiles = engine.analyzeLines(frameNum, lines, level, session);
+        
+        Napi::Array result = Napi::Array::New(env, profiles.size());
+        for (size_t i = 0; i < profiles.size(); i++) {
+            if (buckets > 0) {
+                result[i] = BucketsToObject(env, ThermalEngine::bucketProfile(profiles[i], buckets));
+            } else {
+                Napi::Float32Array temperatures = Napi::Float32Array::New(env, profiles[i].size());
+                std::copy(profiles[i].begin(), profiles[i].end(), temperatures.Data());
+                result[i] = temperatures;
+            }
+        }
+        
+        return result;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error analyzing lines: ") + e.what());
+    }
+}
+
+// Drop the temperature plane of a session (client disconnected)
+Napi::Value ReleaseSession(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        uint32_t session = static_cast<uint32_t>(GetNumberParam(info, 0, "session"));
+        engine.releaseSession(session);
+        return env.Undefined();
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error releasing session: ") + e.what());
+    }
+}
+
+// Analyze a polyline or smooth path: points is an Array or Float32Array of
+// x, y pairs. Returns a Float32Array of temperatures, or a bucket object
+// when options.buckets > 0.
+Napi::Value AnalyzePath(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: frameNum, points, [{ smooth, spacing, level, buckets }]
+        if (info.Length() < 2) {
+            throw Napi::TypeError::New(env, "Expected at least 2 arguments: frameNum, points");
+        }
+        
+        int frameNum = GetIntParam(info, 0, "frameNum");
+        PathSpec path;
+        path.points = GetFloatArray(env, info[1], "points");
+        int level = 0;
+        int buckets = 0;
+        
+        if (info.Length() > 2 && info[2].IsObject()) {
+            Napi::Object options = info[2].As<Napi::Object>();
+            if (options.Get("smooth").IsBoolean()) {
+                path.smooth = options.Get("smooth").As<Napi::Boolean>().Value();
+            }
+            if (options.Get("spacing").IsNumber()) {
+                path.spacing = options.Get("spacing").As<Napi::Number>().FloatValue();
+            }
+            if (options.Get("level").IsNumber()) {
+                level = options.Get("level").As<Napi::Number>().Int32Value();
+            }
+            if (options.Get("buckets").IsNumber()) {
+                buckets = options.Get("buckets").As<Napi::Number>().Int32Value();
+            }
+        }
+        
+        if (path.points.size() < 2 || path.points.size() % 2 != 0 || path.pointCount() > MAX_PATH_POINTS) {
+            throw Napi::RangeError::New(env, "points must hold 1 to " + std::to_string(MAX_PATH_POINTS) + " x, y pairs");
+        }
+        
+        for (float value : path.points) {
+            if (!std::isfinite(value) || std::fabs(value) > LINE_COORD_LIMIT) {
+                throw Napi::RangeError::New(env, "points must be finite pixel coordinates");
+            }
+        }
+        
+        if (!(path.spacing >= 0.25f && path.spacing <= 1024.0f)) {
+            throw Napi::RangeError::New(env, "spacing must be between 0.25 and 1024 pixels");
+        }
+        
+        if (level < 0 || level > 4) {
+            throw Napi::RangeError::New(env, "Pyramid level must be between 0 and 4");
+        }
+        
+        if (buckets < 0 || buckets > 8192) {
+            throw Napi::RangeError::New(env, "Bucket count must be between 0 and 8192");
+        }
+        
+        if (frameNum < 0 || frameNum >= engine.getTotalFrames()) {
+            throw Napi::RangeError::New(env, "Frame number out of range");
+        }
+        
+        std::vector<float> profile = engine.analyzePath(frameNum, path, level);
+        
+        if (buckets > 0) {
+            return BucketsToObject(env, ThermalEngine::bucketProfile(profile, buckets));
+        }
+        
+        Napi::Float32Array temperatures = Napi::Float32Array::New(env, profile.size());
+        std::copy(profile.begin(), profile.end(), temperatures.Data());
+        return temperatures;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error analyzing path: ") + e.what());
+    }
+}
+
+// Radial probe: analyzeRadial(frameNum, { x, y, radius, sectors = 8 }) returns
+// { radial: Float32Array (mean per 1-pixel ring), sectors: [Float32Array per
+// sector], stats }, or null when the frame cannot be analyzed
+Napi::Value AnalyzeRadial(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: frameNum, { x, y, radius, [sectors] }
+        if (info.Length() < 2 || !info[1].IsObject()) {
+            throw Napi::TypeError::New(env, "Expected 2 arguments: frameNum, { x, y, radius, sectors }");
+        }
+        
+        int frameNum = GetIntParam(info, 0, "frameNum");
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (!options.Get("x").IsNumber() || !options.Get("y").IsNumber() || !options.Get("radius").IsNumber()) {
+            throw Napi::TypeError::New(env, "probe needs numeric x, y and radius");
+        }
+        
+        RadialSpec spec;
+        spec.x = options.Get("x").As<Napi::Number>().Int32Value();
+        spec.y = options.Get("y").As<Napi::Number>().Int32Value();
+        spec.radius = options.Get("radius").As<Napi::Number>().Int32Value();
+        spec.sectors = options.Get("sectors").IsNumber() ? options.Get("sectors").As<Napi::Number>().Int32Value() : 8;
+        
+        if (spec.radius < 0 || spec.radius > MAX_PROBE_RADIUS) {
+            throw Napi::RangeError::New(env, "radius must be between 0 and " + std::to_string(MAX_PROBE_RADIUS));
+        }
+        
+        if (spec.sectors < 1 || spec.sectors > MAX_PROBE_SECTORS) {
+            throw Napi::RangeError::New(env, "sectors must be between 1 and " + std::to_string(MAX_PROBE_SECTORS));
+        }
+        
+        if (frameNum < 0 || frameNum >= engine.getTotalFrames()) {
+            throw Napi::RangeError::New(env, "Frame number out of range");
+        }
+        
+        std::shared_ptr<const RadialProfile> profile = engine.analyzeRadial(frameNum, spec);
+        if (!profile) {
+            return env.Null();
+        }
+        
+        Napi::Float32Array radial = Napi::Float32Array::New(env, profile->rings);
+        std::copy(profile->radial.begin(), profile->radial.end(), radial.Data());
+        
+        Napi::Array sectors = Napi::Array::New(env, profile->sectors);
+        for (int s = 0; s < profile->sectors; s++) {
+            Napi::Float32Array sector = Napi::Float32Array::New(env, profile->rings);
+            auto begin = profile->sector.begin() + static_cast<size_t>(s) * profile->rings;
+            std::copy(begin, begin + profile->rings, sector.Data());
+            sectors[s] = sector;
+        }
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("radial", radial);
+        result.Set("sectors", sectors);
+        result.Set("stats", StatsToObject(env, profile->stats));
+        return result;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error analyzing radial profile: ") + e.what());
+    }
+}
+
+// Convert the result of a query run to { frames: Int32Array, valid:
+// Uint8Array, outputs: [{ geometry, reduce, rows, cols, data: Float32Array }] }
+// with one row per frame; stats rows are [min, max, avg, count]
+Napi::Object QueryResultToObject(Napi::Env env, const QueryPlan& plan, const std::vector<int>& frameList,
+                                 const QueryResult& result) {
+    Napi::Int32Array frames = Napi::Int32Array::New(env, frameList.size());
+    std::copy(frameList.begin(), frameList.end(), frames.Data());
+    
+    Napi::Uint8Array valid = Napi::Uint8Array::New(env, result.valid.size());
+    std::copy(result.valid.begin(), result.valid.end(), valid.Data());
+    
+    const char* reducerNames[4] = { "profile", "stats", "histogram", "kymograph" };
+    Napi::Array outputs = Napi::Array::New(env, result.outputs.size());
+    for (size_t o = 0; o < result.outputs.size(); o++) {
+        const QueryMatrix& matrix = result.outputs[o];
+        Napi::Float32Array data = Napi::Float32Array::New(env, matrix.values.size());
+        std::copy(matrix.values.begin(), matrix.values.end(), data.Data());
+        
+        Napi::Object output = Napi::Object::New(env);
+        output.Set("geometry", Napi::Number::New(env, plan.outputs[o].geometry));
+        output.Set("reduce", Napi::String::New(env, reducerNames[static_cast<int>(plan.outputs[o].reducer)]));
+        output.Set("rows", Napi::Number::New(env, matrix.rows));
+        output.Set("cols", Napi::Number::New(env, matrix.cols));
+        output.Set("data", data);
+        outputs[o] = output;
+    }
+    
+    Napi::Object response = Napi::Object::New(env);
+    response.Set("frames", frames);
+    response.Set("valid", valid);
+    response.Set("outputs", outputs);
+    return response;
+}
+
+// Helper function to compile the query of info[0] for the loaded video and
+// read its frames
+std::shared_ptr<const QueryPlan> GetQueryParam(const Napi::CallbackInfo& info, std::vector<int>& frames) {
+    Napi::Env env = info.Env();
+    
+    // Validate parameters: query
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        throw Napi::TypeError::New(env, "Expected 1 argument: query");
+    }
+    
+    if (!engine.isVideoLoaded()) {
+        throw Napi::Error::New(env, "Video not loaded");
+    }
+    
+    Napi::Object query = info[0].As<Napi::Object>();
+    QuerySpec spec = GetQuerySpec(env, query);
+    
+    std::string error;
+    std::shared_ptr<const QueryPlan> plan = engine.compileQuery(spec, error);
+    if (!plan) {
+        throw Napi::RangeError::New(env, error);
+    }
+    
+    frames = GetQueryFrames(env, query.Get("frames"), plan->maxFrames());
+    return plan;
+}
+
+// Helper function to look up the prepared query of info[0] and read the
+// frames of info[1]
+std::shared_ptr<const QueryPlan> GetPreparedQueryParam(const Napi::CallbackInfo& info, std::vector<int>& frames) {
+    Napi::Env env = info.Env();
+    
+    // Validate parameters: handle, frames
+    if (info.Length() < 2) {
+        throw Napi::TypeError::New(env, "Expected 2 arguments: handle, frames");
+    }
+    
+    uint32_t handle = static_cast<uint32_t>(GetNumberParam(info, 0, "handle"));
+    std::shared_ptr<const QueryPlan> plan = engine.getPreparedQuery(handle);
+    if (!plan) {
+        throw Napi::RangeError::New(env, "Unknown query handle: " + std::to_string(handle));
+    }
+    
+    if (!plan->fits(engine.getFrameWidth(), engine.getFrameHeight())) {
+        throw Napi::Error::New(env, "Query was prepared for another video");
+    }
+    
+    frames = GetQueryFrames(env, info[1], plan->maxFrames());
+    return plan;
+}
+
+// Run a batched query (see GetQuerySpec) on query.frames (see GetQueryFrames).
+// The compiled plan is cached, so repeating a query skips rasterization.
+Napi::Value RunQuery(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        std::vector<int> frames;
+        std::shared_ptr<const QueryPlan> plan = GetQueryParam(info, frames);
+        return QueryResultToObject(env, *plan, frames, engine.runQuery(*plan, frames));
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error running query: ") + e.what());
+    }
+}
+
+// Compile a query (see GetQuerySpec, frames are given per execution) and
+// return a handle for executeQuery
+Napi::Value PrepareQuery(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: query
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            throw Napi::TypeError::New(env, "Expected 1 argument: query");
+        }
+        
+        if (!engine.isVideoLoaded()) {
+            throw Napi::Error::New(env, "Video not loaded");
+        }
+        
+        QuerySpec spec = GetQuerySpec(env, info[0].As<Napi::Object>());
+        
+        std::string error;
+        uint32_t handle = engine.prepareQuery(spec, error);
+        if (handle == 0) {
+            throw Napi::RangeError::New(env, error);
+        }
+        
+        return Napi::Number::New(env, handle);
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error preparing query: ") + e.what());
+    }
+}
+
+// Run a prepared query on frames (frameNum, [frameNum, ...] or
+// { start, end, step }); returns the same object as runQuery
+Napi::Value ExecuteQuery(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        std::vector<int> frames;
+        std::shared_ptr<const QueryPlan> plan = GetPreparedQueryParam(info, frames);
+        return QueryResultToObject(env, *plan, frames, engine.runQuery(*plan, frames));
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error executing query: ") + e.what());
+    }
+}
+
+// Promise settled on the JS thread once task completes on the engine's
+// executors; toValue(env, value) converts the result
+template <typename T, typename ToValue>
+Napi::Promise SettleOnCompletion(Napi::Env env, Task<T> task, const std::string& errorPrefix, ToValue toValue) {
+    Napi::Promise::Deferred deferred = Napi::Promise::Deferred::New(env);
+    Napi::ThreadSafeFunction settle = Napi::ThreadSafeFunction::New(env, Napi::Function(), "asyncEngine", 0, 1);
+    
+    spawn(std::move(task), [deferred, settle, errorPrefix, toValue](std::shared_ptr<T> value, std::exception_ptr error) mutable {
+        settle.BlockingCall([deferred, value, error, errorPrefix, toValue](Napi::Env env, Napi::Function) {
+            if (value) {
+                deferred.Resolve(toValue(env, *value));
+                return;
+            }
+            
+            std::string message = "Unknown error";
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception& e) {
+                message = e.what();
+            } catch (...) {
+            }
+            deferred.Reject(Napi::Error::New(env, errorPrefix + message).Value());
+        });
+        settle.Release();
+    });
+    
+    return deferred.Promise();
+}
+
+// runQuery without blocking the JS thread: frames are decoded while the
+// previous ones are converted; resolves to the same object as runQuery
+Napi::Value RunQueryAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        std::vector<int> frames;
+        std::shared_ptr<const QueryPlan> plan = GetQueryParam(info, frames);
+        return SettleOnCompletion(env, asyncEngine.runQuery(plan, frames), "Error running query: ",
+            [plan, frames](Napi::Env env, const QueryResult& result) {
+                return QueryResultToObject(env, *plan, frames, result);
+            });
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error running query: ") + e.what());
+    }
+}
+
+// executeQuery without blocking the JS thread (see runQueryAsync)
+Napi::Value ExecuteQueryAsync(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        std::vector<int> frames;
+        std::shared_ptr<const QueryPlan> plan = GetPreparedQueryParam(info, frames);
+        return SettleOnCompletion(env, asyncEngine.runQuery(plan, frames), "Error executing query: ",
+            [plan, frames](Napi::Env env, const QueryResult& result) {
+                return QueryResultToObject(env, *plan, frames, result);
+            });
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error executing query: ") + e.what());
+    }
+}
+
+// Drop a prepared query
+Napi::Value ReleaseQuery(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        uint32_t handle = static_cast<uint32_t>(GetNumberParam(info, 0, "handle"));
+        engine.releaseQuery(handle);
+        return env.Undefined();
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error releasing query: ") + e.what());
+    }
+}
+
+// Convert a live result to a JS object (runs on the JS thread)
+Napi::Object LiveResultToObject(Napi::Env env, const LiveResult& live) {
+    Napi::Array lines = Napi::Array::New(env, live.lines.size());
+    for (size_t i = 0; i < live.lines.size(); i++) {
+        const std::vector<float>& temps = live.lines[i].temperatures;
+        Napi::Array temperatures = Napi::Array::New(env, temps.size());
+        for (size_t j = 0; j < temps.size(); j++) {
+            temperatures[j] = Napi::Number::New(env, temps[j]);
+        }
+        
+        Napi::Object line = Napi::Object::New(env);
+        line.Set("temperatures", temperatures);
+        line.Set("stats", StatsToObject(env, live.lines[i].stats));
+        lines[i] = line;
+    }
+    
+    Napi::Array rois = Napi::Array::New(env, live.regions.size());
+    for (size_t i = 0; i < live.regions.size(); i++) {
+        rois[i] = StatsToObject(env, live.regions[i]);
+    }
+    
+    Napi::Array alarms = Napi::Array::New(env, live.alarms.size());
+    for (size_t i = 0; i < live.alarms.size(); i++) {
+        const AlarmEvent& event = live.alarms[i];
+        Napi::Object alarm = Napi::Object::New(env);
+        alarm.Set("rule", Napi::String::New(env, event.ruleId));
+        alarm.Set("frame", Napi::Number::New(env, static_cast<double>(event.frame)));
+        alarm.Set("timestamp", Napi::Number::New(env, event.timestamp));
+        alarm.Set("value", Napi::Number::New(env, event.value));
+        alarm.Set("state", Napi::String::New(env, event.raised ? "raised" : "cleared"));
+        alarms[i] = alarm;
+    }
+    
+    Napi::Object result = Napi::Object::New(env);
+    if (live.ended) {
+        result.Set("ended", Napi::Boolean::New(env, true));
+    }
+    result.Set("frame", Napi::Number::New(env, static_cast<double>(live.frameIndex)));
+    result.Set("timestamp", Napi::Number::New(env, live.timestamp));
+    result.Set("latencyMs", Napi::Number::New(env, live.latencyMs));
+    result.Set("droppedFrames", Napi::Number::New(env, static_cast<double>(live.droppedFrames)));
+    result.Set("lines", lines);
+    result.Set("rois", rois);
+    result.Set("alarms", alarms);
+    return result;
+}
+
+// Release the live result callback once capture has stopped
+void ReleaseLiveCallback() {
+    if (liveCallbackActive) {
+        liveCallback.Release();
+        liveCallbackActive = false;
+    }
+}
+
+// Start live capture from a growing file, named pipe or stdin
+Napi::Value StartLive(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: options, callback
+        if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+            throw Napi::TypeError::New(env, "Expected 2 arguments: options, callback");
+        }
+        
+        Napi::Object options = info[0].As<Napi::Object>();
+        if (!options.Get("source").IsString()) {
+            throw Napi::TypeError::New(env, "options.source must be 'file', 'pipe' or 'stdin'");
+        }
+        
+        std::string source = options.Get("source").As<Napi::String>().Utf8Value();
+        std::string path = options.Get("path").IsString() ? options.Get("path").As<Napi::String>().Utf8Value() : "";
+        int width = options.Get("width").IsNumber() ? options.Get("width").As<Napi::Number>().Int32Value() : 0;
+        int height = options.Get("height").IsNumber() ? options.Get("height").As<Napi::Number>().Int32Value() : 0;
+        
+        std::unique_ptr<FrameSource> frameSource;
+        if (source == "file") {
+            frameSource.reset(new TailingVideoSource(path));
+        } else if (source == "pipe") {
+            frameSource.reset(new RawPipeSource(path, width, height));
+        } else if (source == "stdin") {
+            frameSource.reset(new RawPipeSource("-", width, height));
+        } else {
+            throw Napi::TypeError::New(env, "Unknown live source: " + source);
+        }
+        
+        LiveConfig config = GetLiveConfig(env, options);
+        
+        liveCapture.stop();
+        ReleaseLiveCallback();
+        
+        // Queue at most a couple of results; newer frames win over stale ones.
+        // The queue itself is unbounded so the end of the source is never
+        // dropped; anything queued by an earlier run is ignored.
+        liveCallback = Napi::ThreadSafeFunction::New(env, info[1].As<Napi::Function>(), "liveCapture", 0, 1);
+        liveCallbackActive = true;
+        uint32_t generation = ++liveGeneration;
+        
+        bool success = liveCapture.start(std::move(frameSource), config, [generation](LiveResult* result) {
+            bool ended = result->ended;
+            if (!ended && liveQueued.fetch_add(1) >= MAX_QUEUED_LIVE_RESULTS) {
+                liveQueued--;
+                delete result;  // JS side is behind, drop this result
+                return false;
+            }
+            
+            napi_status status = liveCallback.NonBlockingCall(result,
+                [generation](Napi::Env env, Napi::Function callback, LiveResult* live) {
+                    if (!live->ended) {
+                        liveQueued--;
+                    }
+                    // Results of an earlier run carry its line and ROI offsets
+                    if (generation == liveGeneration) {
+                        callback.Call({ LiveResultToObject(env, *live) });
+                    }
+                    delete live;
+                });
+            
+            if (status != napi_ok) {
+                if (!ended) {
+                    liveQueued--;
+                }
+                delete result;
+                return false;
+            }
+            return true;
+        });
+        
+        if (!success) {
+            ReleaseLiveCallback();
+        }
+        
+        return Napi::Boolean::New(env, success);
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error starting live capture: ") + e.what());
+    }
+}
+
+// Stop live capture
+Napi::Value StopLive(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        liveCapture.stop();
+        ReleaseLiveCallback();
+        return env.Undefined();
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error stopping live capture: ") + e.what());
+    }
+}
+
+// Replace the lines, ROIs and alarm rules of the running live capture
+Napi::Value ConfigureLive(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            throw Napi::TypeError::New(env, "Expected 1 argument: { lines, rois, rules }");
+        }
+        
+        liveCapture.configure(GetLiveConfig(env, info[0].As<Napi::Object>()));
+        return Napi::Boolean::New(env, liveCapture.isRunning());
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error configuring live capture: ") + e.what());
+    }
 }
 
-// Helper function to validate and extract string parameters
-std::string GetStringParam(const Napi::CallbackInfo& info, int index, const std::string& paramName) {
-    if (info.Length() <= index || !info[index].IsString()) {
-        throw Napi::TypeError::New(info.Env(), paramName + " must be a string");
+// Release the broadcast result callback once the broadcast has stopped
+void ReleaseBroadcastCallback() {
+    if (broadcastCallbackActive) {
+        broadcastCallback.Release();
+        broadcastCallbackActive = false;
     }
-    return info[index].As<Napi::String>().Utf8Value();
 }
 
-// Load video file
-Napi::Value LoadVideo(const Napi::CallbackInfo& info) {
+// Play the loaded video once for every subscribed viewer
+Napi::Value StartBroadcast(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     try {
-        // Validate parameters
-        if (info.Length() < 1) {
-            throw Napi::TypeError::New(env, "Expected 1 argument: video path");
+        // Validate parameters: { start, rate }, callback(subscriberId, result)
+        if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsFunction()) {
+            throw Napi::TypeError::New(env, "Expected 2 arguments: { start, rate }, callback");
         }
         
-        std::string videoPath = GetStringParam(info, 0, "videoPath");
+        Napi::Object options = info[0].As<Napi::Object>();
+        int start = options.Get("start").IsNumber() ? options.Get("start").As<Napi::Number>().Int32Value() : 0;
+        double rate = options.Get("rate").IsNumber() ? options.Get("rate").As<Napi::Number>().DoubleValue() : 1.0;
         
-        // Load video
-        bool success = engine.loadVideo(videoPath);
+        if (start < 0 || (engine.getTotalFrames() > 0 && start >= engine.getTotalFrames())) {
+            throw Napi::RangeError::New(env, "start is out of range");
+        }
+        if (!std::isfinite(rate) || rate < 0.1 || rate > 16.0) {
+            throw Napi::RangeError::New(env, "rate must be between 0.1 and 16");
+        }
         
-        if (success) {
-            std::cout << "Video loaded successfully via Node.js binding" << std::endl;
-        } else {
-            std::cout << "Failed to load video via Node.js binding" << std::endl;
+        broadcast.stop();
+        ReleaseBroadcastCallback();
+        
+        // A couple of results per subscriber; a subscriber behind the queue
+        // skips frames. The queue itself is unbounded so the end of the
+        // recording is never dropped; an end queued by an earlier broadcast
+        // is ignored.
+        broadcastCallback = Napi::ThreadSafeFunction::New(env, info[1].As<Napi::Function>(), "frameBroadcast", 0, 1);
+        broadcastCallbackActive = true;
+        uint32_t generation = ++broadcastGeneration;
+        
+        typedef std::pair<uint32_t, LiveResult*> SubscriberResult;
+        bool success = broadcast.start(start, rate, [generation](uint32_t subscriberId, LiveResult* result) {
+            bool ended = result->ended;
+            if (!ended && broadcastQueued.fetch_add(1) >= MAX_BROADCAST_SUBSCRIBERS * 2) {
+                broadcastQueued--;
+                delete result;  // JS side is behind, drop this result
+                return;
+            }
+            
+            SubscriberResult* data = new SubscriberResult(subscriberId, result);
+            napi_status status = broadcastCallback.NonBlockingCall(data,
+                [generation](Napi::Env env, Napi::Function callback, SubscriberResult* subscriberResult) {
+                    const LiveResult& live = *subscriberResult->second;
+                    if (!live.ended) {
+                        broadcastQueued--;
+                    }
+                    if (!live.ended || generation == broadcastGeneration) {
+                        callback.Call({ Napi::Number::New(env, subscriberResult->first),
+                                        LiveResultToObject(env, live) });
+                    }
+                    delete subscriberResult->second;
+                    delete subscriberResult;
+                });
+            
+            if (status != napi_ok) {
+                if (!ended) {
+                    broadcastQueued--;
+                }
+                delete result;
+                delete data;
+            }
+        });
+        
+        if (!success) {
+            ReleaseBroadcastCallback();
         }
         
         return Napi::Boolean::New(env, success);
         
     } catch (const std::exception& e) {
-        throw Napi::Error::New(env, std::string("Error loading video: ") + e.what());
+        throw Napi::Error::New(env, std::string("Error starting broadcast: ") + e.what());
     }
 }
 
-// Load temperature mapping CSV
-Napi::Value LoadTempMapping(const Napi::CallbackInfo& info) {
+// Stop the broadcast and drop every subscriber
+Napi::Value StopBroadcast(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     try {
-        // Validate parameters
-        if (info.Length() < 1) {
-            throw Napi::TypeError::New(env, "Expected 1 argument: CSV path");
+        broadcast.stop();
+        ReleaseBroadcastCallback();
+        return env.Undefined();
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error stopping broadcast: ") + e.what());
+    }
+}
+
+// Add a subscriber to the running broadcast, or replace its lines and ROIs
+Napi::Value SubscribeBroadcast(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: subscriberId, { lines, rois }
+        if (info.Length() < 2 || !info[1].IsObject()) {
+            throw Napi::TypeError::New(env, "Expected 2 arguments: subscriberId, { lines, rois }");
         }
         
-        std::string csvPath = GetStringParam(info, 0, "csvPath");
+        uint32_t subscriberId = static_cast<uint32_t>(GetNumberParam(info, 0, "subscriberId"));
+        Napi::Object options = info[1].As<Napi::Object>();
         
-        // Load temperature mapping
-        bool success = engine.loadTempMapping(csvPath);
+        BroadcastConfig config;
+        if (options.Get("lines").IsArray()) {
+            Napi::Array lines = options.Get("lines").As<Napi::Array>();
+            for (uint32_t i = 0; i < lines.Length(); i++) {
+                config.lines.push_back(GetLineObject(env, lines[i], "lines[" + std::to_string(i) + "]"));
+            }
+        }
+        if (options.Get("rois").IsArray()) {
+            Napi::Array rois = options.Get("rois").As<Napi::Array>();
+            for (uint32_t i = 0; i < rois.Length(); i++) {
+                config.regions.push_back(GetRegionObject(env, rois[i], "rois[" + std::to_string(i) + "]"));
+            }
+        }
         
-        if (success) {
-            std::cout << "Temperature mapping loaded successfully via Node.js binding" << std::endl;
-        } else {
-            std::cout << "Failed to load temperature mapping via Node.js binding" << std::endl;
+        if (config.lines.size() + config.regions.size() > MAX_BATCH_LINES) {
+            throw Napi::RangeError::New(env, "At most " + std::to_string(MAX_BATCH_LINES) +
+                                        " lines and ROIs per subscriber");
+        }
+        
+        return Napi::Boolean::New(env, broadcast.subscribe(subscriberId, config));
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error subscribing to broadcast: ") + e.what());
+    }
+}
+
+// Remove a subscriber; unknown ids are ignored
+Napi::Value UnsubscribeBroadcast(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        uint32_t subscriberId = static_cast<uint32_t>(GetNumberParam(info, 0, "subscriberId"));
+        broadcast.unsubscribe(subscriberId);
+        return env.Undefined();
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error unsubscribing from broadcast: ") + e.what());
+    }
+}
+
+// Broadcast state for health checks
+Napi::Value GetBroadcastState(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        Napi::Object state = Napi::Object::New(env);
+        state.Set("running", Napi::Boolean::New(env, broadcast.isRunning()));
+        state.Set("position", Napi::Number::New(env, broadcast.getPosition()));
+        state.Set("decodedFrames", Napi::Number::New(env, static_cast<double>(broadcast.getDecodedFrames())));
+        state.Set("subscribers", Napi::Number::New(env, static_cast<double>(broadcast.getSubscriberCount())));
+        return state;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error getting broadcast state: ") + e.what());
+    }
+}
+
+// Build golden-reference envelope from known-good recordings
+Napi::Value BuildEnvelope(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: videoPaths, lines, envelopePath, [phaseBins]
+        if (info.Length() < 3 || !info[0].IsArray() || !info[1].IsArray()) {
+            throw Napi::TypeError::New(env, "Expected arguments: videoPaths[], lines[], envelopePath, [phaseBins]");
         }
         
+        Napi::Array pathArray = info[0].As<Napi::Array>();
+        std::vector<std::string> videoPaths;
+        for (uint32_t i = 0; i < pathArray.Length(); i++) {
+            Napi::Value path = pathArray[i];
+            if (!path.IsString()) {
+                throw Napi::TypeError::New(env, "videoPaths must contain strings");
+            }
+            videoPaths.push_back(path.As<Napi::String>().Utf8Value());
+        }
+        
+        Napi::Array lineArray = info[1].As<Napi::Array>();
+        std::vector<LineSegment> lines;
+        for (uint32_t i = 0; i < lineArray.Length(); i++) {
+            lines.push_back(GetLineObject(env, lineArray[i], "lines[" + std::to_string(i) + "]"));
+        }
+        
+        std::string envelopePath = GetStringParam(info, 2, "envelopePath");
+        int phaseBins = info.Length() > 3 ? GetIntParam(info, 3, "phaseBins") : 200;
+        
+        if (phaseBins <= 0) {
+            throw Napi::RangeError::New(env, "phaseBins must be positive");
+        }
+        
+        bool success = engine.buildEnvelope(videoPaths, lines, phaseBins, envelopePath);
         return Napi::Boolean::New(env, success);
         
     } catch (const std::exception& e) {
-        throw Napi::Error::New(env, std::string("Error loading temperature mapping: ") + e.what());
+        throw Napi::Error::New(env, std::string("Error building envelope: ") + e.what());
     }
 }
 
-// Analyze temperature along a line
-Napi::Value AnalyzeLine(const Napi::CallbackInfo& info) {
+// Score a recording against a stored envelope
+Napi::Value ScoreEnvelope(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
     
     try {
-        // Validate parameters: frameNum, x1, y1, x2, y2
-        if (info.Length() < 5) {
-            throw Napi::TypeError::New(env, "Expected 5 arguments: frameNum, x1, y1, x2, y2");
+        // Validate parameters: videoPath, envelopePath, [options]
+        if (info.Length() < 2) {
+            throw Napi::TypeError::New(env, "Expected 2 arguments: videoPath, envelopePath");
         }
         
-        int frameNum = static_cast<int>(GetNumberParam(info, 0, "frameNum"));
-        int x1 = static_cast<int>(GetNumberParam(info, 1, "x1"));
-        int y1 = static_cast<int>(GetNumberParam(info, 2, "y1"));
-        int x2 = static_cast<int>(GetNumberParam(info, 3, "x2"));
-        int y2 = static_cast<int>(GetNumberParam(info, 4, "y2"));
+        std::string videoPath = GetStringParam(info, 0, "videoPath");
+        std::string envelopePath = GetStringParam(info, 1, "envelopePath");
         
-        // Validate frame number
-        if (frameNum < 0 || frameNum >= engine.getTotalFrames()) {
-            throw Napi::RangeError::New(env, "Frame number out of range");
+        float tolerance = 0.0f;
+        bool usePercentiles = false;
+        
+        if (info.Length() > 2 && info[2].IsObject()) {
+            Napi::Object options = info[2].As<Napi::Object>();
+            if (options.Get("tolerance").IsNumber()) {
+                tolerance = options.Get("tolerance").As<Napi::Number>().FloatValue();
+            }
+            if (options.Get("usePercentiles").IsBoolean()) {
+                usePercentiles = options.Get("usePercentiles").As<Napi::Boolean>().Value();
+            }
         }
         
-        // Analyze line
-        std::vector<float> temperatures = engine.analyzeLine(frameNum, x1, y1, x2, y2);
+        int framesScored = 0;
+        std::vector<EnvelopeViolation> violations =
+            engine.scoreEnvelope(videoPath, envelopePath, tolerance, usePercentiles, framesScored);
         
-        // Convert std::vector<float> to Napi::Array
-        Napi::Array result = Napi::Array::New(env, temperatures.size());
+        static const char* measureNames[MEASURE_COUNT] = { "min", "max", "avg" };
         
-        for (size_t i = 0; i < temperatures.size(); i++) {
-            result[i] = Napi::Number::New(env, temperatures[i]);
+        Napi::Array violationArray = Napi::Array::New(env, violations.size());
+        std::vector<int> flaggedFrames;
+        
+        for (size_t i = 0; i < violations.size(); i++) {
+            const EnvelopeViolation& v = violations[i];
+            
+            Napi::Object item = Napi::Object::New(env);
+            item.Set("frame", Napi::Number::New(env, v.frame));
+            item.Set("phaseBin", Napi::Number::New(env, v.phaseBin));
+            item.Set("line", Napi::Number::New(env, v.line));
+            item.Set("measure", Napi::String::New(env, measureNames[v.measure]));
+            item.Set("value", Napi::Number::New(env, v.value));
+            item.Set("lo", Napi::Number::New(env, v.lo));
+            item.Set("hi", Napi::Number::New(env, v.hi));
+            violationArray[i] = item;
+            
+            if (flaggedFrames.empty() || flaggedFrames.back() != v.frame) {
+                flaggedFrames.push_back(v.frame);
+            }
+        }
+        
+        Napi::Array frameArray = Napi::Array::New(env, flaggedFrames.size());
+        for (size_t i = 0; i < flaggedFrames.size(); i++) {
+            frameArray[i] = Napi::Number::New(env, flaggedFrames[i]);
         }
         
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("frames", Napi::Number::New(env, framesScored));
+        result.Set("flaggedFrames", frameArray);
+        result.Set("violations", violationArray);
+        
         return result;
         
     } catch (const std::exception& e) {
-        throw Napi::Error::New(env, std::string("Error analyzing line: ") + e.what());
+        throw Napi::Error::New(env, std::string("Error scoring envelope: ") + e.what());
+    }
+}
+
+// Export temperature planes of the loaded video as a volume file
+Napi::Value ExportVolume(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: volumePath, [{ format, start, end, step }]
+        if (info.Length() < 1) {
+            throw Napi::TypeError::New(env, "Expected 1 argument: volumePath");
+        }
+        
+        std::string volumePath = GetStringParam(info, 0, "volumePath");
+        TempFormat format = TempFormat::U16_DECI;
+        int startFrame = 0;
+        int endFrame = engine.getTotalFrames() - 1;
+        int frameStep = 1;
+        
+        if (info.Length() > 1 && info[1].IsObject()) {
+            Napi::Object options = info[1].As<Napi::Object>();
+            if (!options.Get("format").IsUndefined()) {
+                format = GetTempFormat(env, options.Get("format"), "format");
+            }
+            if (options.Get("start").IsNumber()) {
+                startFrame = options.Get("start").As<Napi::Number>().Int32Value();
+            }
+            if (options.Get("end").IsNumber()) {
+                endFrame = options.Get("end").As<Napi::Number>().Int32Value();
+            }
+            if (options.Get("step").IsNumber()) {
+                frameStep = options.Get("step").As<Napi::Number>().Int32Value();
+            }
+        }
+        
+        if (frameStep <= 0) {
+            throw Napi::RangeError::New(env, "step must be positive");
+        }
+        
+        int framesWritten = 0;
+        bool success = engine.exportVolume(volumePath, format, startFrame, endFrame, frameStep, framesWritten);
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("success", Napi::Boolean::New(env, success));
+        result.Set("frames", Napi::Number::New(env, framesWritten));
+        result.Set("format", Napi::String::New(env, TEMP_FORMAT_NAMES[static_cast<int>(format)]));
+        return result;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error exporting volume: ") + e.what());
+    }
+}
+
+// Open a temperature volume for tile streaming; returns its layout or null
+Napi::Value OpenVolume(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        if (info.Length() < 1) {
+            throw Napi::TypeError::New(env, "Expected 1 argument: volumePath");
+        }
+        
+        std::string volumePath = GetStringParam(info, 0, "volumePath");
+        if (!engine.openVolume(volumePath)) {
+            return env.Null();
+        }
+        
+        const TemperatureVolume& volume = engine.getVolume();
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("width", Napi::Number::New(env, volume.width));
+        result.Set("height", Napi::Number::New(env, volume.height));
+        result.Set("frames", Napi::Number::New(env, volume.frameCount));
+        result.Set("firstFrame", Napi::Number::New(env, volume.firstFrame));
+        result.Set("frameStep", Napi::Number::New(env, volume.frameStep));
+        result.Set("format", Napi::String::New(env, TEMP_FORMAT_NAMES[static_cast<int>(volume.format)]));
+        result.Set("io", Napi::String::New(env, engine.getVolumeIoBackend()));
+        return result;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error opening volume: ") + e.what());
+    }
+}
+
+// Most frames accepted by one getVolumeTiles call
+static const size_t MAX_TILE_BATCH = 32;
+
+// Convert encoded tiles to [{ x, y, width, height, data }], or null
+Napi::Value TilesToArray(Napi::Env env, const std::shared_ptr<const std::vector<VolumeTile>>& tiles) {
+    if (!tiles) {
+        return env.Null();
+    }
+    
+    Napi::Array result = Napi::Array::New(env, tiles->size());
+    for (size_t i = 0; i < tiles->size(); i++) {
+        const VolumeTile& tile = (*tiles)[i];
+        Napi::Object item = Napi::Object::New(env);
+        item.Set("x", Napi::Number::New(env, tile.x));
+        item.Set("y", Napi::Number::New(env, tile.y));
+        item.Set("width", Napi::Number::New(env, tile.width));
+        item.Set("height", Napi::Number::New(env, tile.height));
+        item.Set("data", Napi::Buffer<uint8_t>::Copy(env, tile.data.data(), tile.data.size()));
+        result[i] = item;
+    }
+    
+    return result;
+}
+
+// Encoded temperature tiles of a frame: [{ x, y, width, height, data }] or
+// null. Given an array of frames, returns one such entry per frame; the
+// frames are read from the volume in one batch.
+Napi::Value GetVolumeTiles(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: frameNum | [frameNum, ...], [tileSize]
+        if (info.Length() < 1) {
+            throw Napi::TypeError::New(env, "Expected arguments: frameNum, [tileSize]");
+        }
+        
+        int tileSize = info.Length() > 1 ? GetIntParam(info, 1, "tileSize") : 128;
+        
+        if (tileSize < 8 || tileSize > 1024) {
+            throw Napi::RangeError::New(env, "tileSize must be between 8 and 1024");
+        }
+        
+        if (info[0].IsArray()) {
+            Napi::Array frameArray = info[0].As<Napi::Array>();
+            if (frameArray.Length() > MAX_TILE_BATCH) {
+                throw Napi::RangeError::New(env, "At most " + std::to_string(MAX_TILE_BATCH) + " frames per call");
+            }
+            
+            std::vector<int> frames;
+            for (uint32_t i = 0; i < frameArray.Length(); i++) {
+                Napi::Value frame = frameArray[i];
+                if (!frame.IsNumber()) {
+                    throw Napi::TypeError::New(env, "frames[" + std::to_string(i) + "] must be a number");
+                }
+                frames.push_back(frame.As<Napi::Number>().Int32Value());
+            }
+            
+            auto tiles = engine.getVolumeTiles(frames, tileSize);
+            Napi::Array result = Napi::Array::New(env, tiles.size());
+            for (size_t i = 0; i < tiles.size(); i++) {
+                result[i] = TilesToArray(env, tiles[i]);
+            }
+            return result;
+        }
+        
+        int frameNum = GetIntParam(info, 0, "frameNum");
+        return TilesToArray(env, engine.getVolumeTiles(frameNum, tileSize));
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error getting volume tiles: ") + e.what());
     }
 }
 
@@ -138,6 +1729,150 @@ Napi::Value GetVideoInfo(const Napi::CallbackInfo& info) {
     }
 }
 
+// Queue frames for low-priority background decoding (most likely first)
+Napi::Value PrefetchFrames(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        if (info.Length() < 1 || !info[0].IsArray()) {
+            throw Napi::TypeError::New(env, "Expected 1 argument: frames[]");
+        }
+        
+        Napi::Array frameArray = info[0].As<Napi::Array>();
+        std::vector<int> frames;
+        frames.reserve(frameArray.Length());
+        
+        for (uint32_t i = 0; i < frameArray.Length(); i++) {
+            Napi::Value frame = frameArray[i];
+            if (!frame.IsNumber()) {
+                throw Napi::TypeError::New(env, "frames must contain numbers");
+            }
+            frames.push_back(frame.As<Napi::Number>().Int32Value());
+        }
+        
+        engine.prefetchFrames(frames);
+        return env.Undefined();
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error prefetching frames: ") + e.what());
+    }
+}
+
+// Get occupancy and hit statistics of the engine-wide cache
+Napi::Value GetCacheStats(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        const CacheManager& cache = engine.getCacheManager();
+        
+        Napi::Object classes = Napi::Object::New(env);
+        for (int i = 0; i < static_cast<int>(CacheClass::COUNT); i++) {
+            CacheClassStats stats = cache.getStats(static_cast<CacheClass>(i));
+            
+            Napi::Object classStats = Napi::Object::New(env);
+            classStats.Set("entries", Napi::Number::New(env, static_cast<double>(stats.entries)));
+            classStats.Set("bytes", Napi::Number::New(env, static_cast<double>(stats.bytes)));
+            classStats.Set("hits", Napi::Number::New(env, static_cast<double>(stats.hits)));
+            classStats.Set("misses", Napi::Number::New(env, static_cast<double>(stats.misses)));
+            classStats.Set("evictions", Napi::Number::New(env, static_cast<double>(stats.evictions)));
+            classStats.Set("weight", Napi::Number::New(env, cache.getWeight(static_cast<CacheClass>(i))));
+            classes.Set(CACHE_CLASS_NAMES[i], classStats);
+        }
+        
+        Napi::Object result = Napi::Object::New(env);
+        result.Set("budgetBytes", Napi::Number::New(env, static_cast<double>(cache.getBudget())));
+        result.Set("usedBytes", Napi::Number::New(env, static_cast<double>(cache.getUsed())));
+        result.Set("prefetchedFrames", Napi::Number::New(env, static_cast<double>(engine.getPrefetchedCount())));
+        result.Set("decodedFrames", Napi::Number::New(env, static_cast<double>(engine.getFrameService().getDecodeCount())));
+        result.Set("sharedDecodes", Napi::Number::New(env, static_cast<double>(engine.getFrameService().getSharedCount())));
+        result.Set("classes", classes);
+        
+        return result;
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error getting cache stats: ") + e.what());
+    }
+}
+
+// Set the global cache budget and per-class weights
+Napi::Value ConfigureCache(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        // Validate parameters: { budgetMB, weights: { frame, temperature, result, geometry } }
+        if (info.Length() < 1 || !info[0].IsObject()) {
+            throw Napi::TypeError::New(env, "Expected 1 argument: { budgetMB, weights }");
+        }
+        
+        Napi::Object options = info[0].As<Napi::Object>();
+        size_t budgetBytes = engine.getCacheManager().getBudget();
+        
+        if (options.Get("budgetMB").IsNumber()) {
+            double budgetMB = options.Get("budgetMB").As<Napi::Number>().DoubleValue();
+            if (budgetMB < 0) {
+                throw Napi::RangeError::New(env, "budgetMB must not be negative");
+            }
+            budgetBytes = static_cast<size_t>(budgetMB * 1024 * 1024);
+        }
+        
+        double weights[static_cast<int>(CacheClass::COUNT)] = {};
+        if (options.Get("weights").IsObject()) {
+            Napi::Object weightObj = options.Get("weights").As<Napi::Object>();
+            for (int i = 0; i < static_cast<int>(CacheClass::COUNT); i++) {
+                Napi::Value weight = weightObj.Get(CACHE_CLASS_NAMES[i]);
+                if (weight.IsNumber()) {
+                    weights[i] = weight.As<Napi::Number>().DoubleValue();
+                }
+            }
+        }
+        
+        engine.configureCache(budgetBytes, weights);
+        return env.Undefined();
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error configuring cache: ") + e.what());
+    }
+}
+
+// Select the layout of cached (displayed) frames: "planar" or "interleaved"
+Napi::Value SetFrameLayout(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        std::string layout = GetStringParam(info, 0, "layout");
+        
+        if (layout == "planar") {
+            engine.setFrameLayout(FrameLayout::PLANAR);
+        } else if (layout == "interleaved") {
+            engine.setFrameLayout(FrameLayout::INTERLEAVED);
+        } else {
+            throw Napi::RangeError::New(env, "layout must be 'planar' or 'interleaved'");
+        }
+        
+        return env.Undefined();
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error setting frame layout: ") + e.what());
+    }
+}
+
+// Select the format of cached temperature data: "f32", "f16" or "u16"
+Napi::Value SetTemperatureFormat(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    
+    try {
+        if (info.Length() < 1) {
+            throw Napi::TypeError::New(env, "Expected 1 argument: format");
+        }
+        
+        engine.setTemperatureFormat(GetTempFormat(env, info[0], "format"));
+        return env.Undefined();
+        
+    } catch (const std::exception& e) {
+        throw Napi::Error::New(env, std::string("Error setting temperature format: ") + e.what());
+    }
+}
+
 // Get temperature for a specific pixel
 Napi::Value GetPixelTemperature(const Napi::CallbackInfo& info) {
     Napi::Env env = info.Env();
@@ -148,9 +1883,9 @@ Napi::Value GetPixelTemperature(const Napi::CallbackInfo& info) {
             throw Napi::TypeError::New(env, "Expected 3 arguments: r, g, b");
         }
         
-        int r = static_cast<int>(GetNumberParam(info, 0, "r"));
-        int g = static_cast<int>(GetNumberParam(info, 1, "g"));
-        int b = static_cast<int>(GetNumberParam(info, 2, "b"));
+        int r = GetIntParam(info, 0, "r");
+        int g = GetIntParam(info, 1, "g");
+        int b = GetIntParam(info, 2, "b");
         
         // Validate RGB values
         if (r < 0 || r > 255 || g < 0 || g > 255 || b < 0 || b > 255) {
@@ -192,7 +1927,7 @@ Napi::Value GetFrameBase64(const Napi::CallbackInfo& info) {
             throw Napi::TypeError::New(env, "Expected 1 argument: frameNum");
         }
         
-        int frameNum = static_cast<int>(GetNumberParam(info, 0, "frameNum"));
+        int frameNum = GetIntParam(info, 0, "frameNum");
         
         cv::Mat frame = engine.getFrame(frameNum);
         if (frame.empty()) {
@@ -242,12 +1977,51 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
         exports.Set("loadVideo", Napi::Function::New(env, LoadVideo));
         exports.Set("loadTempMapping", Napi::Function::New(env, LoadTempMapping));
         exports.Set("analyzeLine", Napi::Function::New(env, AnalyzeLine));
+        exports.Set("analyzeLineBuckets", Napi::Function::New(env, AnalyzeLineBuckets));
+        exports.Set("analyzeLines", Napi::Function::New(env, AnalyzeLines));
+        exports.Set("releaseSession", Napi::Function::New(env, ReleaseSession));
+        exports.Set("analyzePath", Napi::Function::New(env, AnalyzePath));
+        exports.Set("analyzeRadial", Napi::Function::New(env, AnalyzeRadial));
+        exports.Set("runQuery", Napi::Function::New(env, RunQuery));
+        exports.Set("prepareQuery", Napi::Function::New(env, PrepareQuery));
+        exports.Set("executeQuery", Napi::Function::New(env, ExecuteQuery));
+        exports.Set("releaseQuery", Napi::Function::New(env, ReleaseQuery));
+        exports.Set("runQueryAsync", Napi::Function::New(env, RunQueryAsync));
+        exports.Set("executeQueryAsync", Napi::Function::New(env, ExecuteQueryAsync));
         exports.Set("getVideoInfo", Napi::Function::New(env, GetVideoInfo));
         
         // Utility functions
         exports.Set("getPixelTemperature", Napi::Function::New(env, GetPixelTemperature));
         exports.Set("isReady", Napi::Function::New(env, IsReady));
         exports.Set("getFrameBase64", Napi::Function::New(env, GetFrameBase64));
+        exports.Set("prefetchFrames", Napi::Function::New(env, PrefetchFrames));
+        exports.Set("getCacheStats", Napi::Function::New(env, GetCacheStats));
+        exports.Set("configureCache", Napi::Function::New(env, ConfigureCache));
+        exports.Set("setFrameLayout", Napi::Function::New(env, SetFrameLayout));
+        exports.Set("setTemperatureFormat", Napi::Function::New(env, SetTemperatureFormat));
+        exports.Set("encodeTemperatures", Napi::Function::New(env, EncodeTemperatures));
+        exports.Set("encodeProfile", Napi::Function::New(env, EncodeProfile));
+        
+        // Batch QA functions
+        exports.Set("buildEnvelope", Napi::Function::New(env, BuildEnvelope));
+        exports.Set("scoreEnvelope", Napi::Function::New(env, ScoreEnvelope));
+        exports.Set("exportVolume", Napi::Function::New(env, ExportVolume));
+        
+        // Client-side sampling functions
+        exports.Set("openVolume", Napi::Function::New(env, OpenVolume));
+        exports.Set("getVolumeTiles", Napi::Function::New(env, GetVolumeTiles));
+        
+        // Live capture functions
+        exports.Set("startLive", Napi::Function::New(env, StartLive));
+        exports.Set("stopLive", Napi::Function::New(env, StopLive));
+        exports.Set("configureLive", Napi::Function::New(env, ConfigureLive));
+        
+        // Shared playback functions
+        exports.Set("startBroadcast", Napi::Function::New(env, StartBroadcast));
+        exports.Set("stopBroadcast", Napi::Function::New(env, StopBroadcast));
+        exports.Set("subscribeBroadcast", Napi::Function::New(env, SubscribeBroadcast));
+        exports.Set("unsubscribeBroadcast", Napi::Function::New(env, UnsubscribeBroadcast));
+        exports.Set("getBroadcastState", Napi::Function::New(env, GetBroadcastState));
         
         std::cout << "Thermal Engine Node.js binding initialized successfully" << std::endl;
         
@@ -29,9 +29,14 @@
       }],
       "cflags!": [ "-fno-exceptions" ],
       "cflags_cc!": [ "-fno-exceptions" ],
+      "cflags_cc": [ "-std=c++20" ],
+      "xcode_settings": {
+        "CLANG_CXX_LANGUAGE_STANDARD": "c++20"
+      },
       "msvs_settings": {
         "VCCLCompilerTool": { 
           "ExceptionHandling": 1,
+          "AdditionalOptions": [ "/std:c++20" ],
           "AdditionalIncludeDirectories": [
             "C:/opencv/build/include"
           ]
@@ -0,0 +1,232 @@
+#pragma once
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// One memory budget for every cache in the engine. Entries of all classes
+// compete for the same bytes; when the budget is exceeded the entry with the
+// lowest retention score among a random sample of EVICTION_SAMPLES entries
+// is evicted (scores change with time, so they cannot be kept in order):
+//
+//   score = classWeight * recomputeCostMs * reuseProbability / megabytes
+//
+// reuseProbability grows with the number of hits and decays with the time
+// since the entry was last used.
+
+enum class CacheClass : int {
+    FRAME = 0,        // Decoded BGR frames
+    TEMPERATURE = 1,  // Converted temperature planes/tiles
+    RESULT = 2,       // Analysis results (profiles, stats)
+    GEOMETRY = 3,     // Rasterized geometry
+    COUNT = 4
+};
+
+static const char* CACHE_CLASS_NAMES[static_cast<int>(CacheClass::COUNT)] = {
+    "frame", "temperature", "result", "geometry"
+};
+
+struct CacheClassStats {
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+};
+
+class CacheManager {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Key {
+        CacheClass cls;
+        uint64_t id;
+        bool operator==(const Key& other) const { return cls == other.cls && id == other.id; }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<uint64_t>()(key.id * 31 + static_cast<uint64_t>(key.cls));
+        }
+    };
+
+    struct Entry {
+        std::shared_ptr<const void> value;
+        const void* type;  // typeTag<T>() of value
+        size_t bytes;
+        double costMs;
+        size_t hits;
+        Clock::time_point lastUse;
+        size_t slot;  // Position of the key in keys
+    };
+
+    static constexpr double IDLE_HALF_LIFE_S = 10.0;
+    static constexpr int CLASS_COUNT = static_cast<int>(CacheClass::COUNT);
+    static constexpr size_t EVICTION_SAMPLES = 16;
+
+    std::unordered_map<Key, Entry, KeyHash> entries;
+    std::vector<Key> keys;  // Keys of entries, for sampling
+    std::minstd_rand random;
+    size_t budgetBytes;
+    size_t usedBytes = 0;
+    double weights[CLASS_COUNT] = { 1.0, 1.0, 1.0, 1.0 };
+    CacheClassStats stats[CLASS_COUNT];
+    mutable std::mutex mutex;
+
+    // Distinct address per value type. Keys of different types may collide
+    // (they are hashes), so get<T> checks the tag before casting; no RTTI
+    template <typename T>
+    static const void* typeTag() {
+        static const char tag = 0;
+        return &tag;
+    }
+
+    double score(const Key& key, const Entry& entry, Clock::time_point now) const {
+        double idle = std::chrono::duration<double>(now - entry.lastUse).count();
+        double reuse = (entry.hits + 1.0) / (entry.hits + 2.0) * IDLE_HALF_LIFE_S / (IDLE_HALF_LIFE_S + idle);
+        double megabytes = entry.bytes / (1024.0 * 1024.0) + 1e-6;
+        return weights[static_cast<int>(key.cls)] * (entry.costMs + 0.01) * reuse / megabytes;
+    }
+
+    void evictLocked(size_t needed) {
+        Clock::time_point now = Clock::now();
+
+        while (usedBytes + needed > budgetBytes && !entries.empty()) {
+            // Small caches are scanned whole
+            size_t samples = std::min(EVICTION_SAMPLES, keys.size());
+            std::uniform_int_distribution<size_t> pick(0, keys.size() - 1);
+
+            auto victim = entries.end();
+            double victimScore = 0.0;
+            for (size_t i = 0; i < samples; i++) {
+                auto it = entries.find(keys[samples == keys.size() ? i : pick(random)]);
+                double s = score(it->first, it->second, now);
+                if (victim == entries.end() || s < victimScore) {
+                    victim = it;
+                    victimScore = s;
+                }
+            }
+
+            removeLocked(victim);
+            stats[static_cast<int>(victim->first.cls)].evictions++;
+            entries.erase(victim);
+        }
+    }
+
+    void removeLocked(std::unordered_map<Key, Entry, KeyHash>::iterator it) {
+        CacheClassStats& classStats = stats[static_cast<int>(it->first.cls)];
+        classStats.entries--;
+        classStats.bytes -= it->second.bytes;
+        usedBytes -= it->second.bytes;
+
+        size_t slot = it->second.slot;
+        keys[slot] = keys.back();
+        keys.pop_back();
+        if (slot < keys.size()) {
+            entries.find(keys[slot])->second.slot = slot;
+        }
+    }
+
+public:
+    explicit CacheManager(size_t budget) : budgetBytes(budget) {}
+
+    template <typename T>
+    std::shared_ptr<const T> get(CacheClass cls, uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find({ cls, id });
+        CacheClassStats& classStats = stats[static_cast<int>(cls)];
+
+        if (it == entries.end() || it->second.type != typeTag<T>()) {
+            classStats.misses++;
+            return nullptr;
+        }
+
+        it->second.hits++;
+        it->second.lastUse = Clock::now();
+        classStats.hits++;
+        return std::static_pointer_cast<const T>(it->second.value);
+    }
+
+    bool contains(CacheClass cls, uint64_t id) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return entries.count({ cls, id }) > 0;
+    }
+
+    // costMs is what it took to produce the value, i.e. what eviction loses
+    template <typename T>
+    void put(CacheClass cls, uint64_t id, std::shared_ptr<const T> value, size_t bytes, double costMs) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (bytes > budgetBytes) return;
+
+        auto existing = entries.find({ cls, id });
+        if (existing != entries.end()) {
+            removeLocked(existing);
+            entries.erase(existing);
+        }
+
+        evictLocked(bytes);
+
+        entries[{ cls, id }] = { std::static_pointer_cast<const void>(value), typeTag<T>(), bytes, costMs, 0,
+                                 Clock::now(), keys.size() };
+        keys.push_back({ cls, id });
+        CacheClassStats& classStats = stats[static_cast<int>(cls)];
+        classStats.entries++;
+        classStats.bytes += bytes;
+        usedBytes += bytes;
+    }
+
+    void erase(CacheClass cls, uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find({ cls, id });
+        if (it != entries.end()) {
+            removeLocked(it);
+            entries.erase(it);
+        }
+    }
+
+    void clear(CacheClass cls) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->first.cls == cls) {
+                removeLocked(it);
+                it = entries.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void configure(size_t budget, const double classWeights[CLASS_COUNT]) {
+        std::lock_guard<std::mutex> lock(mutex);
+        budgetBytes = budget;
+        for (int i = 0; i < CLASS_COUNT; i++) {
+            weights[i] = classWeights[i] > 0 ? classWeights[i] : weights[i];
+        }
+        evictLocked(0);
+    }
+
+    size_t getBudget() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return budgetBytes;
+    }
+
+    size_t getUsed() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return usedBytes;
+    }
+
+    double getWeight(CacheClass cls) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return weights[static_cast<int>(cls)];
+    }
+
+    CacheClassStats getStats(CacheClass cls) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return stats[static_cast<int>(cls)];
+    }
+};
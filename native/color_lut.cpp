@@ -0,0 +1,255 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <limits>
+#include <algorithm>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include "numa_alloc.cpp"
+#include "simd.cpp"
+
+// Colour to temperature conversion through a dense 24-bit lookup table.
+//
+// The palette (the temperature mapping CSV) is kept as a structure of arrays
+// in the mapping's iteration order. Every packed RGB value has one uint16
+// slot holding palette index + 1; 0 means not resolved yet. Slots are filled
+// lazily on first use by the closest-colour search, which keeps the original
+// semantics: the first palette entry closer than 10 in RGB distance, or else
+// the first entry with the smallest distance.
+//
+// The table is 32 MB of zero-filled virtual memory; only pages of colours
+// that actually occur are touched. Slots are read without the resolve lock,
+// so scalar code accesses them through loadSlot/storeSlot (relaxed atomics:
+// a reader sees either 0 and resolves again, or the final value).
+
+class ColorLut {
+private:
+    static constexpr size_t TABLE_ENTRIES = 1u << 24;
+    static constexpr size_t MAX_PALETTE = 65535;
+    static constexpr int NEAR_DISTANCE_SQ = 100;  // Distance < 10
+    static constexpr int16_t PADDING_COLOR = 2000;  // Never the closest entry
+
+    std::vector<int16_t> paletteR, paletteG, paletteB;  // Padded to a multiple of 8
+    std::vector<float> temps;                           // temps[0] = -1 (no match)
+    size_t paletteSize = 0;
+
+    uint16_t* table = nullptr;
+    size_t tableBytes = 0;
+    std::unordered_map<uint32_t, uint16_t> exactIndex;
+    std::mutex resolveMutex;
+
+    // Closest palette index for a colour with no exact entry
+    size_t nearestScalar(int r, int g, int b) const {
+        int best = std::numeric_limits<int>::max();
+        size_t bestIndex = 0;
+
+        for (size_t i = 0; i < paletteSize; i++) {
+            int dr = r - paletteR[i];
+            int dg = g - paletteG[i];
+            int db = b - paletteB[i];
+            int d = dr * dr + dg * dg + db * db;
+
+            if (d < best) {
+                best = d;
+                bestIndex = i;
+                if (d < NEAR_DISTANCE_SQ) break;
+            }
+        }
+
+        return bestIndex;
+    }
+
+#ifdef THERMAL_X86
+    // Eight palette entries per step. The first block with an entry closer
+    // than 10 decides; otherwise per-lane minima are reduced to the first
+    // index of the overall minimum.
+    THERMAL_TARGET_AVX2 size_t nearestAvx2(int r, int g, int b) const {
+        const __m256i vr = _mm256_set1_epi32(r);
+        const __m256i vg = _mm256_set1_epi32(g);
+        const __m256i vb = _mm256_set1_epi32(b);
+        const __m256i nearLimit = _mm256_set1_epi32(NEAR_DISTANCE_SQ);
+        const __m256i step = _mm256_set1_epi32(8);
+
+        __m256i best = _mm256_set1_epi32(std::numeric_limits<int>::max());
+        __m256i bestIndex = _mm256_setzero_si256();
+        __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        for (size_t i = 0; i < paletteR.size(); i += 8) {
+            __m256i dr = _mm256_sub_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&paletteR[i]))), vr);
+            __m256i dg = _mm256_sub_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&paletteG[i]))), vg);
+            __m256i db = _mm256_sub_epi32(_mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&paletteB[i]))), vb);
+            __m256i d = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(dr, dr), _mm256_mullo_epi32(dg, dg)),
+                                         _mm256_mullo_epi32(db, db));
+
+            int nearMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(nearLimit, d)));
+            if (nearMask) {
+                // Earlier entries in this block are farther than 10, so the
+                // scalar scan would have stopped at the same entry
+                size_t lane = 0;
+                while (!(nearMask & (1 << lane))) lane++;
+                return i + lane;
+            }
+
+            __m256i closer = _mm256_cmpgt_epi32(best, d);
+            best = _mm256_blendv_epi8(best, d, closer);
+            bestIndex = _mm256_blendv_epi8(bestIndex, index, closer);
+            index = _mm256_add_epi32(index, step);
+        }
+
+        alignas(32) int laneBest[8];
+        alignas(32) int laneIndex[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(laneBest), best);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(laneIndex), bestIndex);
+
+        int minDistance = laneBest[0];
+        int minIndex = laneIndex[0];
+        for (int lane = 1; lane < 8; lane++) {
+            if (laneBest[lane] < minDistance || (laneBest[lane] == minDistance && laneIndex[lane] < minIndex)) {
+                minDistance = laneBest[lane];
+                minIndex = laneIndex[lane];
+            }
+        }
+        return static_cast<size_t>(minIndex);
+    }
+
+    // Eight pixels per step: build packed keys from the planes, gather the
+    // palette slots and then the temperatures. Returns how many pixels were
+    // converted; blocks with unresolved colours stop the vector loop.
+    THERMAL_TARGET_AVX2 size_t convertAvx2(const uint8_t* r, const uint8_t* g, const uint8_t* b,
+                                           size_t count, float* out) const {
+        const __m256i slotMask = _mm256_set1_epi32(0xFFFF);
+        const int* slots = reinterpret_cast<const int*>(table);
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            __m256i vr = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(r + i)));
+            __m256i vg = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(g + i)));
+            __m256i vb = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + i)));
+            __m256i key = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(vr, 16), _mm256_slli_epi32(vg, 8)), vb);
+
+            // 32-bit gather at byte offset key * 2; the low half is the slot
+            __m256i slot = _mm256_and_si256(_mm256_i32gather_epi32(slots, key, 2), slotMask);
+            if (!_mm256_testz_si256(_mm256_cmpeq_epi32(slot, _mm256_setzero_si256()), _mm256_set1_epi32(-1))) {
+                break;
+            }
+
+            _mm256_storeu_ps(out + i, _mm256_i32gather_ps(temps.data(), slot, 4));
+        }
+
+        return i;
+    }
+#endif
+
+    uint16_t loadSlot(uint32_t key) const {
+        return std::atomic_ref<uint16_t>(table[key]).load(std::memory_order_relaxed);
+    }
+
+    void storeSlot(uint32_t key, uint16_t slot) {
+        std::atomic_ref<uint16_t>(table[key]).store(slot, std::memory_order_relaxed);
+    }
+
+    uint16_t resolve(uint32_t key) {
+        std::lock_guard<std::mutex> lock(resolveMutex);
+        uint16_t resolved = loadSlot(key);
+        if (resolved) return resolved;
+
+        uint16_t slot;
+        auto exact = exactIndex.find(key);
+        if (exact != exactIndex.end()) {
+            slot = exact->second;
+        } else {
+            int r = (key >> 16) & 0xFF;
+            int g = (key >> 8) & 0xFF;
+            int b = key & 0xFF;
+#ifdef THERMAL_X86
+            size_t index = simd::hasAvx2() ? nearestAvx2(r, g, b) : nearestScalar(r, g, b);
+#else
+            size_t index = nearestScalar(r, g, b);
+#endif
+            slot = static_cast<uint16_t>(index + 1);
+        }
+
+        storeSlot(key, slot);
+        return slot;
+    }
+
+public:
+    ColorLut() : temps(1, -1.0f) {}
+
+    ~ColorLut() {
+        numa::freeLarge(table, tableBytes);
+    }
+
+    ColorLut(const ColorLut&) = delete;
+    ColorLut& operator=(const ColorLut&) = delete;
+
+    // Build from a packed-RGB -> temperature mapping
+    bool build(const std::unordered_map<uint32_t, float>& mapping) {
+        if (mapping.size() > MAX_PALETTE) {
+            std::cerr << "Error: Temperature mapping has more than " << MAX_PALETTE << " colours" << std::endl;
+            return false;
+        }
+
+        // One spare entry so the 32-bit gather of the last slot stays in bounds
+        tableBytes = (TABLE_ENTRIES + 2) * sizeof(uint16_t);
+        table = static_cast<uint16_t*>(numa::allocateLarge(tableBytes));
+        if (!table) {
+            std::cerr << "Error: Could not allocate colour lookup table" << std::endl;
+            return false;
+        }
+
+        for (const auto& pair : mapping) {
+            uint32_t key = pair.first;
+            paletteR.push_back(static_cast<int16_t>((key >> 16) & 0xFF));
+            paletteG.push_back(static_cast<int16_t>((key >> 8) & 0xFF));
+            paletteB.push_back(static_cast<int16_t>(key & 0xFF));
+            temps.push_back(pair.second);
+            exactIndex[key] = static_cast<uint16_t>(paletteR.size());
+        }
+
+        paletteSize = paletteR.size();
+        while (paletteR.size() % 8) {
+            paletteR.push_back(PADDING_COLOR);
+            paletteG.push_back(PADDING_COLOR);
+            paletteB.push_back(PADDING_COLOR);
+        }
+
+        return true;
+    }
+
+    bool empty() const { return paletteSize == 0; }
+
+    // Temperature of one colour, -1 if there is no palette
+    float lookup(int r, int g, int b) {
+        if (empty()) return -1.0f;
+
+        uint32_t key = (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | static_cast<uint32_t>(b);
+        uint16_t slot = loadSlot(key);
+        return temps[slot ? slot : resolve(key)];
+    }
+
+    // Convert count pixels given as separate R, G and B arrays
+    void convert(const uint8_t* r, const uint8_t* g, const uint8_t* b, size_t count, float* out) {
+        if (empty()) {
+            std::fill(out, out + count, -1.0f);
+            return;
+        }
+
+        size_t i = 0;
+        while (i < count) {
+#ifdef THERMAL_X86
+            if (simd::hasAvx2()) {
+                i += convertAvx2(r + i, g + i, b + i, count - i, out + i);
+            }
+#endif
+            // Tail, or a block with colours seen for the first time
+            size_t blockEnd = std::min(count, i + 8);
+            for (; i < blockEnd; i++) {
+                out[i] = lookup(r[i], g[i], b[i]);
+            }
+        }
+    }
+};
@@ -0,0 +1,199 @@
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+#include "geometry.cpp"
+
+// Golden-reference envelopes: per-phase bands of line measurements built
+// from known-good recordings and stored as 0.1 °C fixed point.
+
+enum EnvelopeMeasure {
+    MEASURE_MIN = 0,
+    MEASURE_MAX = 1,
+    MEASURE_AVG = 2,
+    MEASURE_COUNT = 3
+};
+
+struct EnvelopeBand {
+    float lo;
+    float p05;
+    float p50;
+    float p95;
+    float hi;
+    bool valid;
+};
+
+struct EnvelopeViolation {
+    int frame;
+    int phaseBin;
+    int line;
+    int measure;
+    float value;
+    float lo;
+    float hi;
+};
+
+struct Envelope {
+    static constexpr uint32_t MAGIC = 0x564E4554;  // "TENV"
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint16_t NO_DATA = 0xFFFF;
+
+    int phaseBins = 0;
+    int recordings = 0;
+    std::vector<LineSegment> lines;
+    std::vector<EnvelopeBand> bands;  // [bin][line][measure]
+
+    size_t index(int bin, int line, int measure) const {
+        return (static_cast<size_t>(bin) * lines.size() + line) * MEASURE_COUNT + measure;
+    }
+
+    int phaseBin(int frame, int totalFrames) const {
+        if (totalFrames <= 0) return 0;
+        int bin = static_cast<int>(static_cast<int64_t>(frame) * phaseBins / totalFrames);
+        return std::max(0, std::min(bin, phaseBins - 1));
+    }
+
+    static uint16_t quantize(float temp) {
+        float scaled = std::round(temp * 10.0f);
+        return static_cast<uint16_t>(std::max(0.0f, std::min(scaled, 65534.0f)));
+    }
+
+    bool save(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not write envelope file: " << path << std::endl;
+            return false;
+        }
+
+        uint32_t header[5] = {
+            MAGIC, VERSION,
+            static_cast<uint32_t>(phaseBins),
+            static_cast<uint32_t>(lines.size()),
+            static_cast<uint32_t>(recordings)
+        };
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+        for (const auto& line : lines) {
+            int32_t coords[4] = { line.x1, line.y1, line.x2, line.y2 };
+            file.write(reinterpret_cast<const char*>(coords), sizeof(coords));
+        }
+
+        std::vector<uint16_t> packed;
+        packed.reserve(bands.size() * 5);
+        for (const auto& band : bands) {
+            if (!band.valid) {
+                packed.insert(packed.end(), 5, NO_DATA);
+                continue;
+            }
+            packed.push_back(quantize(band.lo));
+            packed.push_back(quantize(band.p05));
+            packed.push_back(quantize(band.p50));
+            packed.push_back(quantize(band.p95));
+            packed.push_back(quantize(band.hi));
+        }
+        file.write(reinterpret_cast<const char*>(packed.data()), packed.size() * sizeof(uint16_t));
+
+        return file.good();
+    }
+
+    bool load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open envelope file: " << path << std::endl;
+            return false;
+        }
+
+        uint32_t header[5];
+        if (!file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+            header[0] != MAGIC || header[1] != VERSION) {
+            std::cerr << "Error: Not a thermal envelope file: " << path << std::endl;
+            return false;
+        }
+
+        phaseBins = static_cast<int>(header[2]);
+        recordings = static_cast<int>(header[4]);
+        lines.resize(header[3]);
+
+        for (auto& line : lines) {
+            int32_t coords[4];
+            if (!file.read(reinterpret_cast<char*>(coords), sizeof(coords))) return false;
+            line = { coords[0], coords[1], coords[2], coords[3] };
+        }
+
+        std::vector<uint16_t> packed(static_cast<size_t>(phaseBins) * lines.size() * MEASURE_COUNT * 5);
+        if (!file.read(reinterpret_cast<char*>(packed.data()), packed.size() * sizeof(uint16_t))) {
+            std::cerr << "Error: Truncated envelope file: " << path << std::endl;
+            return false;
+        }
+
+        bands.resize(packed.size() / 5);
+        for (size_t i = 0; i < bands.size(); i++) {
+            const uint16_t* q = &packed[i * 5];
+            EnvelopeBand& band = bands[i];
+            band.valid = q[0] != NO_DATA;
+            band.lo = q[0] / 10.0f;
+            band.p05 = q[1] / 10.0f;
+            band.p50 = q[2] / 10.0f;
+            band.p95 = q[3] / 10.0f;
+            band.hi = q[4] / 10.0f;
+        }
+
+        return true;
+    }
+};
+
+// Collects measurement samples per (bin, line, measure) slot across recordings
+class EnvelopeAccumulator {
+private:
+    std::vector<std::vector<float>> samples;
+
+    static float percentile(const std::vector<float>& sorted, float p) {
+        float pos = p * (sorted.size() - 1);
+        size_t lower = static_cast<size_t>(pos);
+        size_t upper = std::min(lower + 1, sorted.size() - 1);
+        float frac = pos - lower;
+        return sorted[lower] + (sorted[upper] - sorted[lower]) * frac;
+    }
+
+public:
+    Envelope envelope;
+
+    EnvelopeAccumulator(const std::vector<LineSegment>& lines, int phaseBins) {
+        envelope.lines = lines;
+        envelope.phaseBins = phaseBins;
+        samples.resize(static_cast<size_t>(phaseBins) * lines.size() * MEASURE_COUNT);
+    }
+
+    void add(int bin, int line, int measure, float value) {
+        samples[envelope.index(bin, line, measure)].push_back(value);
+    }
+
+    void add(size_t slot, float value) {
+        samples[slot].push_back(value);
+    }
+
+    Envelope& finish() {
+        envelope.bands.resize(samples.size());
+
+        for (size_t i = 0; i < samples.size(); i++) {
+            std::vector<float>& slot = samples[i];
+            EnvelopeBand& band = envelope.bands[i];
+            band.valid = !slot.empty();
+            if (!band.valid) continue;
+
+            std::sort(slot.begin(), slot.end());
+            band.lo = slot.front();
+            band.p05 = percentile(slot, 0.05f);
+            band.p50 = percentile(slot, 0.50f);
+            band.p95 = percentile(slot, 0.95f);
+            band.hi = slot.back();
+
+            std::vector<float>().swap(slot);
+        }
+
+        return envelope;
+    }
+};
@@ -0,0 +1,303 @@
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <memory>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <iostream>
+#include "geometry.cpp"
+#include "frame_ring.cpp"
+
+// Shared review playback: one decoder thread plays the loaded recording and
+// publishes each frame once into the engine's broadcast ring; every
+// subscriber (a viewer's lines and ROIs) runs on its own analysis thread and
+// reads the newest frame from the ring. Viewers that fall behind skip frames
+// instead of queueing them, so ten viewers cost one decode per frame plus
+// their own sampling. Interactive requests for frames still in the ring are
+// served from it too (see getAnalysisFrame).
+
+static const size_t MAX_BROADCAST_SUBSCRIBERS = 32;
+
+struct BroadcastConfig {
+    std::vector<LineSegment> lines;
+    std::vector<RegionSpec> regions;
+};
+
+// Runs on the engine's sampling functions; included after thermal_engine.cpp
+// and live_capture.cpp (results are LiveResults, frameIndex is the frame number)
+class FrameBroadcast {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Subscriber {
+        uint32_t id;
+        std::mutex configMutex;
+        BroadcastConfig config;
+        std::atomic<bool> active{true};
+        std::thread thread;
+    };
+
+    ThermalEngine& engine;
+    FrameRing& ring;
+    std::thread decoderThread;
+    std::atomic<bool> running{false};
+    bool started = false;
+    std::atomic<int> position{-1};
+    std::atomic<int64_t> decodedFrames{0};
+
+    // Subscribers sleep here between frames; frames themselves are handed
+    // over through the ring
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+
+    std::mutex subscribersMutex;
+    std::unordered_map<uint32_t, std::unique_ptr<Subscriber>> subscribers;
+    std::function<void(uint32_t, LiveResult*)> onResult;
+
+    static double epochMs() {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    // The recording ended (or could not be read) without stop(): wind the
+    // subscribers down here and pass a result with ended set
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(subscribersMutex);
+            if (!running.exchange(false)) return;  // stop() was called
+            for (auto& entry : subscribers) {
+                stopSubscriber(*entry.second);
+            }
+            subscribers.clear();
+        }
+        wake.notify_all();
+
+        LiveResult* result = new LiveResult();
+        result->frameIndex = position;
+        result->droppedFrames = 0;
+        result->timestamp = epochMs();
+        result->latencyMs = 0;
+        result->ended = true;
+        onResult(0, result);
+    }
+
+    // Decode sequentially (no seeks) at rate times real time
+    void decodeLoop(std::string videoPath, int startFrame, double frameIntervalMs) {
+        cv::VideoCapture cap(videoPath);
+        if (!cap.isOpened()) {
+            std::cerr << "Error: Broadcast could not open video: " << videoPath << std::endl;
+            finish();
+            return;
+        }
+
+        if (startFrame > 0) {
+            cap.set(cv::CAP_PROP_POS_FRAMES, startFrame);
+        }
+
+        auto interval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(frameIntervalMs));
+        Clock::time_point due = Clock::now();
+
+        for (int frameNumber = startFrame; running; frameNumber++) {
+            // Frames viewers or the prefetcher already decoded are taken from
+            // the cache; the decoder only steps past them
+            bool decoded = false;
+            Frame frame = engine.getSharedFrame(frameNumber, [&](cv::Mat& out) {
+                decoded = true;
+                return cap.read(out);
+            });
+            if (!decoded && !frame.empty() && !cap.grab()) {
+                frame = Frame();
+            }
+
+            if (frame.empty()) {
+                std::cout << "Broadcast reached the end of the recording" << std::endl;
+                finish();
+                return;
+            }
+
+            // Published frames are never written to again
+            ring.publish(frameNumber, frame, epochMs());
+            position = frameNumber;
+            decodedFrames++;
+
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+            }
+            wake.notify_all();
+
+            // Keep the pace; after a stall, restart it instead of bursting
+            due += interval;
+            Clock::time_point now = Clock::now();
+            if (due < now - interval) {
+                due = now;
+            }
+            std::this_thread::sleep_until(due);
+        }
+
+        running = false;
+        wake.notify_all();
+    }
+
+    void analysisLoop(Subscriber* subscriber) {
+        uint64_t cursor = 0;
+        int64_t skipped = 0;
+
+        while (subscriber->active && running) {
+            FrameRing::Entry entry;
+            if (!ring.latest(cursor, entry)) {
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                wake.wait_for(lock, std::chrono::milliseconds(100), [&] {
+                    return !subscriber->active || !running || ring.epoch() > cursor;
+                });
+                continue;
+            }
+
+            if (cursor > 0) {
+                skipped += static_cast<int64_t>(entry.epoch - cursor - 1);
+            }
+            cursor = entry.epoch;
+
+            BroadcastConfig current;
+            {
+                std::lock_guard<std::mutex> lock(subscriber->configMutex);
+                current = subscriber->config;
+            }
+
+            LiveResult* result = new LiveResult();
+            result->frameIndex = entry.frameNumber;
+            result->droppedFrames = skipped;
+            result->timestamp = entry.timestamp;
+
+            try {
+                for (const auto& line : current.lines) {
+                    LiveLineResult lineResult;
+                    lineResult.temperatures = engine.sampleLine(entry.frame, line.x1, line.y1, line.x2, line.y2);
+                    lineResult.stats = ThermalEngine::computeStats(lineResult.temperatures);
+                    result->lines.push_back(std::move(lineResult));
+                }
+
+                for (const auto& region : current.regions) {
+                    result->regions.push_back(engine.measureRegion(entry.frame, region));
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Exception analyzing broadcast frame: " << e.what() << std::endl;
+                delete result;
+                continue;
+            }
+
+            result->latencyMs = epochMs() - entry.timestamp;
+            onResult(subscriber->id, result);
+        }
+    }
+
+    void stopSubscriber(Subscriber& subscriber) {
+        subscriber.active = false;
+        {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+        }
+        wake.notify_all();
+        if (subscriber.thread.joinable()) {
+            subscriber.thread.join();
+        }
+    }
+
+public:
+    explicit FrameBroadcast(ThermalEngine& thermalEngine)
+        : engine(thermalEngine), ring(thermalEngine.getBroadcastRing()) {}
+
+    ~FrameBroadcast() {
+        stop();
+    }
+
+    // Play the loaded video from startFrame at rate times its frame rate.
+    // onResult runs on subscriber threads and takes ownership of the result.
+    // When the recording ends, the decoder thread stops every subscriber and
+    // passes one last result with ended set (subscriber id 0); stop() does not.
+    bool start(int startFrame, double rate, std::function<void(uint32_t, LiveResult*)> callback) {
+        stop();
+
+        if (!engine.isVideoLoaded() || engine.getFPS() <= 0) {
+            std::cerr << "Error: Video not loaded" << std::endl;
+            return false;
+        }
+
+        onResult = callback;
+        position = -1;
+        decodedFrames = 0;
+        running = true;
+        started = true;
+        decoderThread = std::thread(&FrameBroadcast::decodeLoop, this, engine.getVideoPath(),
+                                    startFrame, 1000.0 / (engine.getFPS() * rate));
+
+        std::cout << "Broadcast started at frame " << startFrame << " (" << rate << "x)" << std::endl;
+        return true;
+    }
+
+    void stop() {
+        running = false;
+        wake.notify_all();
+        if (decoderThread.joinable()) {
+            decoderThread.join();
+        }
+
+        if (!started) return;
+        started = false;
+
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        for (auto& entry : subscribers) {
+            stopSubscriber(*entry.second);
+        }
+        subscribers.clear();
+        std::cout << "Broadcast stopped" << std::endl;
+    }
+
+    // Add a subscriber or replace its geometry; false if the broadcast is
+    // not running or has no room
+    bool subscribe(uint32_t id, const BroadcastConfig& config) {
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        if (!running) return false;
+
+        auto existing = subscribers.find(id);
+        if (existing != subscribers.end()) {
+            std::lock_guard<std::mutex> configLock(existing->second->configMutex);
+            existing->second->config = config;
+            return true;
+        }
+
+        if (subscribers.size() >= MAX_BROADCAST_SUBSCRIBERS) return false;
+
+        std::unique_ptr<Subscriber> subscriber(new Subscriber());
+        subscriber->id = id;
+        subscriber->config = config;
+        subscriber->thread = std::thread(&FrameBroadcast::analysisLoop, this, subscriber.get());
+        subscribers[id] = std::move(subscriber);
+        return true;
+    }
+
+    void unsubscribe(uint32_t id) {
+        std::unique_ptr<Subscriber> subscriber;
+        {
+            std::lock_guard<std::mutex> lock(subscribersMutex);
+            auto it = subscribers.find(id);
+            if (it == subscribers.end()) return;
+            subscriber = std::move(it->second);
+            subscribers.erase(it);
+        }
+        stopSubscriber(*subscriber);
+    }
+
+    bool isRunning() const { return running; }
+    int getPosition() const { return position; }
+    int64_t getDecodedFrames() const { return decodedFrames; }
+
+    size_t getSubscriberCount() {
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        return subscribers.size();
+    }
+};
@@ -0,0 +1,305 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <unordered_map>
+#include <iostream>
+#include <sys/stat.h>
+#include "cache_manager.cpp"
+#include "numa_alloc.cpp"
+#include "planar_frame.cpp"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Decoded frames shared by the interactive path and the prefetcher, stored
+// in the engine-wide cache budget in the configured layout. These are the
+// frames that get displayed, so they stay interleaved BGR unless planar is
+// requested (JPEG encoding would otherwise re-interleave every frame).
+// Cached frames are never written to after insertion.
+class FrameCache {
+private:
+    CacheManager& manager;
+    std::atomic<int> layout{static_cast<int>(FrameLayout::INTERLEAVED)};
+
+public:
+    explicit FrameCache(CacheManager& cacheManager) : manager(cacheManager) {}
+
+    // Keys come from FrameService::frameKey
+    bool get(uint64_t key, Frame& frame) {
+        std::shared_ptr<const Frame> cached = manager.get<Frame>(CacheClass::FRAME, key);
+        if (!cached) {
+            return false;
+        }
+
+        frame = *cached;
+        return true;
+    }
+
+    bool contains(uint64_t key) const {
+        return manager.contains(CacheClass::FRAME, key);
+    }
+
+    // Convert a freshly decoded BGR frame to the analysis layout and store
+    // it; decodeMs is the cost of producing the frame again after eviction
+    Frame put(uint64_t key, const cv::Mat& decoded, double decodeMs) {
+        int64_t startTicks = cv::getTickCount();
+        Frame frame;
+        frame.assign(decoded, getLayout());
+        decodeMs += (cv::getTickCount() - startTicks) * 1000.0 / cv::getTickFrequency();
+
+        manager.put(CacheClass::FRAME, key, std::make_shared<const Frame>(frame), frame.bytes(), decodeMs);
+        return frame;
+    }
+
+    // Cached frames keep their layout until the cache is cleared
+    void setLayout(FrameLayout frameLayout) {
+        layout = static_cast<int>(frameLayout);
+    }
+
+    FrameLayout getLayout() const {
+        return static_cast<FrameLayout>(layout.load());
+    }
+
+    void clear() {
+        manager.clear(CacheClass::FRAME);
+    }
+};
+
+// Process-wide access to decoded frames, keyed by (video, frame number).
+// Frames come from the cache; a missing frame is decoded once even when
+// several sessions, the prefetcher and the broadcast ask for it at the same
+// time: later callers wait for the decode in flight (single-flight) and
+// share its result instead of decoding the frame again.
+class FrameService {
+private:
+    struct Flight {
+        bool done = false;
+        Frame frame;  // Empty if decoding failed
+    };
+
+    FrameCache& cache;
+    std::mutex mutex;
+    std::condition_variable landed;
+    std::unordered_map<uint64_t, std::shared_ptr<Flight>> flights;
+    std::atomic<size_t> decodes{0};
+    std::atomic<size_t> shared{0};
+
+    void finish(uint64_t key, const std::shared_ptr<Flight>& flight, const Frame& frame) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            flight->frame = frame;
+            flight->done = true;
+            flights.erase(key);
+        }
+        landed.notify_all();
+    }
+
+public:
+    explicit FrameService(FrameCache& frameCache) : cache(frameCache) {}
+
+    // Identity of a recording: its path, size and modification time, so a
+    // file re-recorded under the same path never reuses stale frames
+    static uint64_t videoKey(const std::string& path) {
+        uint64_t hash = 1469598103934665603ULL;
+        auto mix = [&hash](const void* data, size_t length) {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (size_t i = 0; i < length; i++) {
+                hash ^= bytes[i];
+                hash *= 1099511628211ULL;
+            }
+        };
+
+        mix(path.data(), path.size());
+        struct stat info;
+        if (stat(path.c_str(), &info) == 0) {
+            int64_t size = static_cast<int64_t>(info.st_size);
+            int64_t modified = static_cast<int64_t>(info.st_mtime);
+            mix(&size, sizeof(size));
+            mix(&modified, sizeof(modified));
+        }
+        return hash;
+    }
+
+    // Cache id of a frame; distinct for every frame of one video
+    static uint64_t frameKey(uint64_t video, int frameNumber) {
+        return (video ^ static_cast<uint32_t>(frameNumber)) * 1099511628211ULL;
+    }
+
+    // Whether the frame is cached or being decoded
+    bool pending(uint64_t video, int frameNumber) {
+        uint64_t key = frameKey(video, frameNumber);
+        if (cache.contains(key)) return true;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        return flights.count(key) > 0;
+    }
+
+    // Cached frame, or the frame decoded by decode(cv::Mat&) -> bool on the
+    // calling thread; empty if decoding failed. A caller that finds the
+    // frame in flight waits for it, even if a low-priority prefetch is
+    // decoding it: that decode has a head start over a new seek.
+    template <typename Decode>
+    Frame get(uint64_t video, int frameNumber, Decode&& decode) {
+        uint64_t key = frameKey(video, frameNumber);
+        Frame frame;
+        if (cache.get(key, frame)) return frame;
+
+        std::shared_ptr<Flight> flight;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            auto it = flights.find(key);
+            if (it != flights.end()) {
+                flight = it->second;
+                shared++;
+                landed.wait(lock, [&flight] { return flight->done; });
+                return flight->frame;
+            }
+
+            // Landed between the lookup above and taking the lock
+            if (cache.contains(key) && cache.get(key, frame)) return frame;
+
+            flight = std::make_shared<Flight>();
+            flights[key] = flight;
+        }
+
+        try {
+            int64_t startTicks = cv::getTickCount();
+            cv::Mat decoded;
+            decoded.allocator = numa::largeBufferAllocator();
+            if (decode(decoded)) {
+                frame = cache.put(key, decoded, (cv::getTickCount() - startTicks) * 1000.0 / cv::getTickFrequency());
+                decodes++;
+            }
+        } catch (...) {
+            finish(key, flight, Frame());
+            throw;
+        }
+
+        finish(key, flight, frame);
+        return frame;
+    }
+
+    size_t getDecodeCount() const { return decodes; }
+    size_t getSharedCount() const { return shared; }
+};
+
+// Decodes predicted frames into the cache on a low-priority thread with its
+// own decoder, so prefetching never moves the interactive decoder's position
+class FramePrefetcher {
+private:
+    FrameService& service;
+    std::string videoPath;
+    uint64_t videoKey = 0;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<int> queue;  // Highest priority first
+    bool stopping = false;
+    std::atomic<size_t> prefetched{0};
+
+    static void lowerThreadPriority() {
+#ifdef _WIN32
+        SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+#elif defined(__linux__)
+        // Linux applies nice values per thread
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+#endif
+    }
+
+    void run() {
+        lowerThreadPriority();
+
+        cv::VideoCapture cap(videoPath);
+        if (!cap.isOpened()) {
+            std::cerr << "Warning: Prefetcher could not open video: " << videoPath << std::endl;
+            return;
+        }
+
+        int position = -1;  // Next frame the decoder will return without seeking
+
+        while (true) {
+            int frameNumber;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping) break;
+
+                frameNumber = queue.front();
+                queue.erase(queue.begin());
+            }
+
+            // Never wait for a frame another thread is already decoding
+            if (service.pending(videoKey, frameNumber)) continue;
+
+            service.get(videoKey, frameNumber, [&](cv::Mat& frame) {
+                // Sequential reads are far cheaper than seeks, so only seek on jumps
+                if (frameNumber != position) {
+                    cap.set(cv::CAP_PROP_POS_FRAMES, frameNumber);
+                }
+
+                if (!cap.read(frame)) {
+                    position = -1;
+                    return false;
+                }
+
+                position = frameNumber + 1;
+                prefetched++;
+                return true;
+            });
+        }
+    }
+
+public:
+    explicit FramePrefetcher(FrameService& frameService) : service(frameService) {}
+
+    ~FramePrefetcher() {
+        stop();
+    }
+
+    void start(const std::string& path, uint64_t key) {
+        stop();
+        videoPath = path;
+        videoKey = key;
+        stopping = false;
+        worker = std::thread(&FramePrefetcher::run, this);
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            queue.clear();
+        }
+        wake.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    // Replace pending work with a new prediction; stale predictions are dropped
+    void request(const std::vector<int>& frames) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue = frames;
+        }
+        wake.notify_all();
+    }
+
+    size_t getPrefetchedCount() const {
+        return prefetched;
+    }
+};
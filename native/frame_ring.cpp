@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include "planar_frame.cpp"
+
+// Single-producer, multi-consumer ring of decoded frames. One decoder
+// publishes into the ring; any number of readers take the newest frame, or
+// a given frame number, without locks. Readers copy the Frame handle, which
+// shares the pixel buffers, so no pixels are copied.
+//
+// Every slot carries an epoch (the publish number of its frame, WRITING
+// while the frame is replaced) and a count of readers copying it. A reader
+// registers and then checks the epoch; the writer marks the slot WRITING and
+// then checks the count, leaving busy slots for the next one. A replaced
+// frame is reclaimed through its buffers' reference counts once the last
+// reader that copied it drops its handle.
+class FrameRing {
+public:
+    struct Entry {
+        uint64_t epoch = 0;   // Publish number, 1 for the first frame
+        int frameNumber = -1;
+        double timestamp = 0; // Publish time, ms since epoch
+        Frame frame;
+    };
+
+    explicit FrameRing(size_t slotCount = 8)
+        : slots(new Slot[slotCount]), count(slotCount) {}
+
+    // Producer only
+    void publish(int frameNumber, const Frame& frame, double timestamp) {
+        uint64_t epoch = published.load(std::memory_order_relaxed) + 1;
+
+        for (size_t attempt = 1; ; attempt++) {
+            Slot& slot = slots[next];
+            next = (next + 1) % count;
+
+            uint64_t previous = slot.epoch.load();
+            slot.epoch.store(WRITING);
+            if (slot.readers.load() != 0) {
+                // A reader is copying this slot: leave it and take the next
+                slot.epoch.store(previous);
+                if (attempt % count == 0) {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+
+            slot.frameNumber.store(frameNumber, std::memory_order_relaxed);
+            slot.timestamp = timestamp;
+            slot.frame = frame;
+            slot.epoch.store(epoch, std::memory_order_release);
+            published.store(epoch, std::memory_order_release);
+            return;
+        }
+    }
+
+    // Newest entry published after epoch after; false if there is none
+    bool latest(uint64_t after, Entry& out) {
+        for (int retry = 0; retry < 4; retry++) {
+            size_t best = count;
+            uint64_t bestEpoch = after;
+            for (size_t i = 0; i < count; i++) {
+                uint64_t epoch = slots[i].epoch.load(std::memory_order_acquire);
+                if (epoch != WRITING && epoch > bestEpoch) {
+                    bestEpoch = epoch;
+                    best = i;
+                }
+            }
+
+            if (best == count) return false;
+            if (copy(slots[best], bestEpoch, out)) return true;
+        }
+        return false;
+    }
+
+    // Entry holding frameNumber, if it is still in the ring
+    bool find(int frameNumber, Entry& out) {
+        for (size_t i = 0; i < count; i++) {
+            uint64_t epoch = slots[i].epoch.load(std::memory_order_acquire);
+            if (epoch == 0 || epoch == WRITING ||
+                slots[i].frameNumber.load(std::memory_order_relaxed) != frameNumber) {
+                continue;
+            }
+            if (copy(slots[i], epoch, out) && out.frameNumber == frameNumber) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Drop every frame, e.g. when another video is loaded; producer only
+    void reset() {
+        for (size_t i = 0; i < count; i++) {
+            Slot& slot = slots[i];
+            slot.epoch.store(WRITING);
+            while (slot.readers.load() != 0) {
+                std::this_thread::yield();
+            }
+            slot.frameNumber.store(-1, std::memory_order_relaxed);
+            slot.frame = Frame();
+            slot.epoch.store(0, std::memory_order_release);
+        }
+    }
+
+    // Publish number of the newest frame, 0 before the first
+    uint64_t epoch() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+private:
+    static constexpr uint64_t WRITING = ~0ULL;
+
+    struct Slot {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<int> readers{0};
+        std::atomic<int> frameNumber{-1};
+        double timestamp = 0;
+        Frame frame;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t count;
+    size_t next = 0;                    // Producer only
+    std::atomic<uint64_t> published{0};
+
+    // The slot is copied only if it still holds epoch once this reader is
+    // registered; the writer never replaces a slot with registered readers
+    static bool copy(Slot& slot, uint64_t epoch, Entry& out) {
+        slot.readers.fetch_add(1);
+        bool valid = slot.epoch.load() == epoch;
+        if (valid) {
+            out.epoch = epoch;
+            out.frameNumber = slot.frameNumber.load(std::memory_order_relaxed);
+            out.timestamp = slot.timestamp;
+            out.frame = slot.frame;
+        }
+        slot.readers.fetch_sub(1, std::memory_order_release);
+        return valid;
+    }
+};
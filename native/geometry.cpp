@@ -0,0 +1,456 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <utility>
+
+// Analysis geometry shared by the engine and its batch/live pipelines
+
+// Line segment in video pixel coordinates
+struct LineSegment {
+    int x1, y1, x2, y2;
+};
+
+// Axis-aligned region of interest in video pixel coordinates
+struct RegionSpec {
+    int x, y, width, height;
+};
+
+// Temperature statistics over the valid (> 0) samples of a line or region
+struct RegionStats {
+    float min = 0;
+    float max = 0;
+    float avg = 0;
+    int count = 0;
+};
+
+// Line profile reduced to equal ranges of samples (one per chart column)
+struct ProfileBuckets {
+    size_t length = 0;                // Samples along the full line
+    std::vector<RegionStats> buckets;
+    RegionStats total;
+};
+
+// Endpoint coordinates beyond this magnitude are rejected by clipLine
+static const int LINE_COORD_LIMIT = 1 << 28;
+
+// The part of the Bresenham line from (x1, y1) to (x2, y2) that lies inside
+// a frame: count pixels starting at (x, y), where the walk's error term is
+// err. Walking it visits exactly the in-frame pixels of the whole line, in
+// order, without per-pixel bounds checks.
+struct LineSpan {
+    int x = 0, y = 0;
+    int dx = 0, dy = 0;  // Extents of the whole line
+    int sx = 1, sy = 1;
+    long long err = 0;
+    int count = 0;
+};
+
+namespace linegeom {
+
+inline long long floorDiv(long long a, long long b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+inline long long ceilDiv(long long a, long long b) {
+    return -floorDiv(-a, b);
+}
+
+// Minor axis steps after k major axis steps. The major coordinate moves on
+// every step of the walk; the minor one follows this closed form.
+inline long long minorSteps(long long k, long long dMajor, long long dMinor) {
+    return dMajor == 0 ? 0 : (2 * k * dMinor + dMajor - 1) / (2 * dMajor);
+}
+
+// Narrow [kLow, kHigh] to the steps whose coordinate start + s * steps(k)
+// is inside [0, size)
+inline void clipMajor(long long start, int s, int size, long long& kLow, long long& kHigh) {
+    kLow = std::max(kLow, s > 0 ? -start : start - size + 1);
+    kHigh = std::min(kHigh, s > 0 ? size - 1 - start : start);
+}
+
+inline void clipMinor(long long start, int s, int size, long long dMajor, long long dMinor,
+                      long long& kLow, long long& kHigh) {
+    long long mLow = s > 0 ? -start : start - size + 1;
+    long long mHigh = s > 0 ? size - 1 - start : start;
+
+    if (dMinor == 0) {
+        if (mLow > 0 || mHigh < 0) kHigh = kLow - 1;
+        return;
+    }
+
+    // minorSteps(k) >= mLow and minorSteps(k) <= mHigh, solved for k
+    kLow = std::max(kLow, ceilDiv((2 * mLow - 1) * dMajor + 1, 2 * dMinor));
+    kHigh = std::min(kHigh, floorDiv((2 * mHigh + 1) * dMajor, 2 * dMinor));
+}
+
+}  // namespace linegeom
+
+// Clip a line against a width x height frame in one step: the walk is a
+// monotone function of the major axis step, so the visible steps form one
+// interval that is solved for directly. Returns false when nothing is visible.
+inline bool clipLine(int x1, int y1, int x2, int y2, int width, int height, LineSpan& span) {
+    span = LineSpan();
+    if (std::abs(x1) > LINE_COORD_LIMIT || std::abs(y1) > LINE_COORD_LIMIT ||
+        std::abs(x2) > LINE_COORD_LIMIT || std::abs(y2) > LINE_COORD_LIMIT ||
+        width <= 0 || height <= 0) {
+        return false;
+    }
+
+    span.dx = std::abs(x2 - x1);
+    span.dy = std::abs(y2 - y1);
+    span.sx = x1 < x2 ? 1 : -1;
+    span.sy = y1 < y2 ? 1 : -1;
+
+    bool xMajor = span.dx >= span.dy;
+    long long dMajor = xMajor ? span.dx : span.dy;
+    long long dMinor = xMajor ? span.dy : span.dx;
+    long long kLow = 0;
+    long long kHigh = dMajor;
+
+    if (xMajor) {
+        linegeom::clipMajor(x1, span.sx, width, kLow, kHigh);
+        linegeom::clipMinor(y1, span.sy, height, dMajor, dMinor, kLow, kHigh);
+    } else {
+        linegeom::clipMajor(y1, span.sy, height, kLow, kHigh);
+        linegeom::clipMinor(x1, span.sx, width, dMajor, dMinor, kLow, kHigh);
+    }
+
+    if (kLow > kHigh) {
+        return false;
+    }
+
+    long long m = linegeom::minorSteps(kLow, dMajor, dMinor);
+    long long xSteps = xMajor ? kLow : m;
+    long long ySteps = xMajor ? m : kLow;
+
+    span.x = static_cast<int>(x1 + span.sx * xSteps);
+    span.y = static_cast<int>(y1 + span.sy * ySteps);
+    span.err = static_cast<long long>(span.dx) - span.dy - xSteps * span.dy + ySteps * span.dx;
+    span.count = static_cast<int>(kHigh - kLow + 1);
+    return true;
+}
+
+// Call visit(x, y) for every pixel of a clipped line
+template <typename Visit>
+inline void walkLineSpan(const LineSpan& span, Visit&& visit) {
+    int x = span.x;
+    int y = span.y;
+    long long err = span.err;
+
+    for (int i = 0; i < span.count; i++) {
+        visit(x, y);
+
+        long long e2 = 2 * err;
+        if (e2 > -span.dy) {
+            err -= span.dy;
+            x += span.sx;
+        }
+        if (e2 < span.dx) {
+            err += span.dx;
+            y += span.sy;
+        }
+    }
+}
+
+// Path through control points in video pixel coordinates, sampled at equal
+// arc length. Smooth paths follow a Catmull-Rom spline through the points;
+// others are polylines.
+struct PathSpec {
+    std::vector<float> points;  // x0, y0, x1, y1, ...
+    bool smooth = false;
+    float spacing = 1.0f;       // Arc length between samples, in pixels
+
+    size_t pointCount() const { return points.size() / 2; }
+};
+
+// Longest path accepted, in control points
+static const size_t MAX_PATH_POINTS = 4096;
+
+// Most samples one path yields (see rasterizePath), and most points a spline
+// segment is flattened to
+static const size_t MAX_PATH_SAMPLES = static_cast<size_t>(1) << 22;
+static const int MAX_SPLINE_STEPS = 256;
+
+namespace pathgeom {
+
+// Points of the uniform Catmull-Rom segment from p1 to p2 (p0 and p3 are
+// its neighbours), excluding p1, appended to out
+inline void appendSpline(const float* p0, const float* p1, const float* p2, const float* p3,
+                         std::vector<float>& out) {
+    double chord = std::hypot(static_cast<double>(p2[0]) - p1[0], static_cast<double>(p2[1]) - p1[1]);
+    int steps = static_cast<int>(std::min<double>(MAX_SPLINE_STEPS, std::max(4.0, std::ceil(chord / 2.0))));
+
+    for (int step = 1; step <= steps; step++) {
+        float t = static_cast<float>(step) / steps;
+        float t2 = t * t;
+        float t3 = t2 * t;
+        for (int axis = 0; axis < 2; axis++) {
+            out.push_back(0.5f * (2.0f * p1[axis] +
+                                  (p2[axis] - p0[axis]) * t +
+                                  (2.0f * p0[axis] - 5.0f * p1[axis] + 4.0f * p2[axis] - p3[axis]) * t2 +
+                                  (3.0f * p1[axis] - p0[axis] - 3.0f * p2[axis] + p3[axis]) * t3));
+        }
+    }
+}
+
+// Dense polyline of a path: the control points themselves, or the spline
+// through them (end points repeated as their own neighbours)
+inline std::vector<float> flatten(const PathSpec& path) {
+    size_t count = path.pointCount();
+    if (!path.smooth || count < 3) {
+        return std::vector<float>(path.points.begin(), path.points.begin() + count * 2);
+    }
+
+    std::vector<float> out(path.points.begin(), path.points.begin() + 2);
+    const float* p = path.points.data();
+    for (size_t i = 0; i + 1 < count; i++) {
+        const float* p0 = p + (i > 0 ? i - 1 : 0) * 2;
+        const float* p3 = p + std::min(i + 2, count - 1) * 2;
+        appendSpline(p0, p + i * 2, p + (i + 1) * 2, p3, out);
+    }
+    return out;
+}
+
+}  // namespace pathgeom
+
+// FNV-1a over everything that determines a path's pixels
+inline uint64_t pathHash(const PathSpec& path, int width, int height, int level) {
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&](uint32_t value) {
+        hash = (hash ^ value) * 1099511628211ULL;
+    };
+
+    for (float value : path.points) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        mix(bits);
+    }
+    uint32_t spacingBits;
+    std::memcpy(&spacingBits, &path.spacing, sizeof(spacingBits));
+    mix(spacingBits);
+    mix(path.smooth ? 1 : 0);
+    mix(static_cast<uint32_t>(width));
+    mix(static_cast<uint32_t>(height));
+    mix(static_cast<uint32_t>(level));
+    return hash;
+}
+
+// Pixels of a path in a width x height frame: one sample every
+// path.spacing pixels of arc length from the first to the last point,
+// rounded to the nearest pixel; samples outside the frame are skipped. With
+// level > 0 the path is sampled on that pyramid level (2^level downscale)
+// and the pixels are returned at full resolution. At most MAX_PATH_SAMPLES
+// pixels are returned; a longer path is cut off there.
+inline std::vector<std::pair<int, int>> rasterizePath(const PathSpec& path, int width, int height, int level = 0) {
+    std::vector<std::pair<int, int>> pixels;
+    if (path.pointCount() == 0 || !(path.spacing > 0)) {
+        return pixels;
+    }
+
+    std::vector<float> polyline = pathgeom::flatten(path);
+    double scale = 1.0 / (1 << level);
+    int levelWidth = (width + (1 << level) - 1) >> level;
+    int levelHeight = (height + (1 << level) - 1) >> level;
+
+    auto emit = [&](double x, double y) {
+        long px = std::lround(x * scale);
+        long py = std::lround(y * scale);
+        if (px >= 0 && px < levelWidth && py >= 0 && py < levelHeight) {
+            pixels.push_back({ static_cast<int>(px) << level, static_cast<int>(py) << level });
+        }
+    };
+
+    // Frame in path coordinates, one level pixel wider on every side; emit()
+    // makes the exact check
+    double minX = -1.0 / scale, maxX = (levelWidth + 1) / scale;
+    double minY = -1.0 / scale, maxY = (levelHeight + 1) / scale;
+
+    // Walk the polyline; sample k lies at arc length k * spacing. Only the
+    // part of each segment inside the frame is walked, so the work is bounded
+    // by the samples kept, not by the path's length.
+    double spacing = path.spacing / scale;
+    double travelled = 0;
+    int64_t next = 1;  // Index of the next sample
+    size_t count = polyline.size() / 2;
+
+    emit(polyline[0], polyline[1]);
+
+    for (size_t i = 1; i < count && pixels.size() < MAX_PATH_SAMPLES; i++) {
+        double x0 = polyline[(i - 1) * 2], y0 = polyline[(i - 1) * 2 + 1];
+        double x1 = polyline[i * 2], y1 = polyline[i * 2 + 1];
+        double dx = x1 - x0, dy = y1 - y0;
+        double length = std::hypot(dx, dy);
+        if (!(length > 0)) continue;
+
+        // Clip the segment to the frame (Liang-Barsky)
+        double t0 = 0, t1 = 1;
+        auto clip = [&](double p, double q) {
+            if (p == 0) return q >= 0;
+            double t = q / p;
+            if (p < 0) t0 = std::max(t0, t);
+            else t1 = std::min(t1, t);
+            return t0 <= t1;
+        };
+
+        if (clip(-dx, x0 - minX) && clip(dx, maxX - x0) && clip(-dy, y0 - minY) && clip(dy, maxY - y0)) {
+            int64_t first = std::max(next, static_cast<int64_t>(std::ceil((travelled + t0 * length) / spacing)));
+            int64_t last = static_cast<int64_t>(std::floor((travelled + t1 * length) / spacing));
+            for (int64_t k = first; k <= last && pixels.size() < MAX_PATH_SAMPLES; k++) {
+                double t = (k * spacing - travelled) / length;
+                emit(x0 + dx * t, y0 + dy * t);
+            }
+        }
+
+        travelled += length;
+        next = std::max(next, static_cast<int64_t>(std::floor(travelled / spacing)) + 1);
+    }
+
+    // The last point is always sampled unless a sample just landed on it
+    if (count > 1 && pixels.size() < MAX_PATH_SAMPLES &&
+        (next - 1) * spacing < travelled - spacing * 0.5) {
+        emit(polyline[(count - 1) * 2], polyline[(count - 1) * 2 + 1]);
+    }
+
+    return pixels;
+}
+
+// Circular probe around (x, y): rings of 1 pixel width out to radius, split
+// into sectors of equal angle. Angles start at +x and run clockwise on screen.
+struct RadialSpec {
+    int x = 0, y = 0;
+    int radius = 0;
+    int sectors = 1;
+};
+
+// Largest probe accepted (keeps ring * sector bins within 16 bits)
+static const int MAX_PROBE_RADIUS = 1024;
+static const int MAX_PROBE_SECTORS = 36;
+
+// Mean temperature per ring, overall and per sector, over valid (> 0) pixels
+struct RadialProfile {
+    int rings = 0;
+    int sectors = 0;
+    std::vector<float> radial;   // rings values
+    std::vector<float> sector;   // sectors x rings values, sector-major
+    RegionStats stats;
+
+    size_t bytes() const {
+        return sizeof(RadialProfile) + (radial.size() + sector.size()) * sizeof(float);
+    }
+};
+
+// Bin of every pixel in the probe's bounding box (clipped to the frame),
+// row-major: ring * sectors + sector, or RING_OUTSIDE beyond the radius
+struct RingTable {
+    static constexpr uint16_t RING_OUTSIDE = 0xFFFF;
+
+    int x0 = 0, y0 = 0, x1 = 0, y1 = 0;  // Bounding box [x0, x1) x [y0, y1)
+    int rings = 0;
+    int sectors = 0;
+    std::vector<uint16_t> bins;
+
+    size_t bytes() const { return sizeof(RingTable) + bins.size() * sizeof(uint16_t); }
+};
+
+inline uint64_t radialHash(const RadialSpec& spec, int width, int height) {
+    uint64_t hash = 1469598103934665603ULL;  // FNV-1a
+    const int fields[6] = { spec.x, spec.y, spec.radius, spec.sectors, width, height };
+    for (int field : fields) {
+        hash = (hash ^ static_cast<uint32_t>(field)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Pixels are assigned to the ring of their rounded distance from the centre
+inline RingTable buildRingTable(const RadialSpec& spec, int width, int height) {
+    RingTable table;
+    table.rings = spec.radius + 1;
+    table.sectors = spec.sectors;
+    table.x0 = std::max(0, spec.x - spec.radius);
+    table.y0 = std::max(0, spec.y - spec.radius);
+    table.x1 = std::min(width, spec.x + spec.radius + 1);
+    table.y1 = std::min(height, spec.y + spec.radius + 1);
+    if (table.x0 >= table.x1 || table.y0 >= table.y1) {
+        table.x1 = table.x0;
+        table.y1 = table.y0;
+        return table;
+    }
+
+    const float fullTurn = 6.28318530718f;
+    const float sectorScale = spec.sectors / fullTurn;
+    table.bins.resize(static_cast<size_t>(table.x1 - table.x0) * (table.y1 - table.y0));
+    uint16_t* bin = table.bins.data();
+
+    for (int y = table.y0; y < table.y1; y++) {
+        int dy = y - spec.y;
+        for (int x = table.x0; x < table.x1; x++, bin++) {
+            int dx = x - spec.x;
+            int ring = static_cast<int>(std::lround(std::sqrt(static_cast<float>(dx * dx + dy * dy))));
+            if (ring > spec.radius) {
+                *bin = RingTable::RING_OUTSIDE;
+                continue;
+            }
+
+            float angle = std::atan2(static_cast<float>(dy), static_cast<float>(dx));
+            if (angle < 0) angle += fullTurn;
+            int sector = std::min(spec.sectors - 1, static_cast<int>(angle * sectorScale));
+            *bin = static_cast<uint16_t>(ring * spec.sectors + sector);
+        }
+    }
+
+    return table;
+}
+
+// Bin the temperatures of the table's bounding box (row-major, as produced
+// by one region conversion) into ring and sector means
+inline RadialProfile accumulateRings(const RingTable& table, const float* temps) {
+    RadialProfile profile;
+    profile.rings = table.rings;
+    profile.sectors = table.sectors;
+
+    size_t binCount = static_cast<size_t>(table.rings) * table.sectors;
+    std::vector<double> sums(binCount, 0.0);
+    std::vector<int> counts(binCount, 0);
+    double total = 0;
+
+    for (size_t i = 0; i < table.bins.size(); i++) {
+        float t = temps[i];
+        uint16_t bin = table.bins[i];
+        if (bin == RingTable::RING_OUTSIDE || !(t > 0)) continue;
+
+        sums[bin] += t;
+        counts[bin]++;
+        if (profile.stats.count == 0 || t < profile.stats.min) profile.stats.min = t;
+        if (profile.stats.count == 0 || t > profile.stats.max) profile.stats.max = t;
+        profile.stats.count++;
+        total += t;
+    }
+
+    if (profile.stats.count > 0) {
+        profile.stats.avg = static_cast<float>(total / profile.stats.count);
+    }
+
+    profile.radial.assign(table.rings, 0.0f);
+    profile.sector.assign(binCount, 0.0f);
+    for (int ring = 0; ring < table.rings; ring++) {
+        double ringSum = 0;
+        int ringCount = 0;
+        for (int sector = 0; sector < table.sectors; sector++) {
+            size_t bin = static_cast<size_t>(ring) * table.sectors + sector;
+            if (counts[bin] > 0) {
+                profile.sector[static_cast<size_t>(sector) * table.rings + ring] = static_cast<float>(sums[bin] / counts[bin]);
+            }
+            ringSum += sums[bin];
+            ringCount += counts[bin];
+        }
+        if (ringCount > 0) {
+            profile.radial[ring] = static_cast<float>(ringSum / ringCount);
+        }
+    }
+
+    return profile;
+}
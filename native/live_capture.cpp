@@ -0,0 +1,426 @@
+#include <opencv2/opencv.hpp>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <vector>
+#include <string>
+#include <iostream>
+#include "geometry.cpp"
+#include "alarm_rules.cpp"
+#include "numa_alloc.cpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Live capture: analyze frames from a growing AVI, a named pipe or stdin
+// while the recording is still being written.
+
+enum class ReadStatus {
+    FRAME,    // A new frame was read
+    PENDING,  // No frame available yet, poll again
+    END       // Source is exhausted or broken
+};
+
+class FrameSource {
+public:
+    virtual ~FrameSource() {}
+    virtual bool open() = 0;
+    virtual ReadStatus read(cv::Mat& frame) = 0;
+    virtual std::string describe() const = 0;
+};
+
+// Tails a video file that another process is still appending to. When the
+// decoder runs out of frames the file is reopened and decoding resumes at the
+// next unread frame.
+class TailingVideoSource : public FrameSource {
+private:
+    std::string path;
+    cv::VideoCapture cap;
+    int nextFrame = 0;
+
+public:
+    explicit TailingVideoSource(const std::string& videoPath) : path(videoPath) {}
+
+    bool open() override {
+        cap.open(path);
+        return cap.isOpened();
+    }
+
+    ReadStatus read(cv::Mat& frame) override {
+        if (cap.isOpened() && cap.read(frame)) {
+            nextFrame++;
+            return ReadStatus::FRAME;
+        }
+
+        // Reopen to pick up frames appended since the last open
+        cap.release();
+        if (!cap.open(path)) {
+            return ReadStatus::PENDING;
+        }
+
+        int available = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
+        if (available > 0 && available <= nextFrame) {
+            return ReadStatus::PENDING;
+        }
+
+        cap.set(cv::CAP_PROP_POS_FRAMES, nextFrame);
+        if (cap.read(frame)) {
+            nextFrame++;
+            return ReadStatus::FRAME;
+        }
+
+        return ReadStatus::PENDING;
+    }
+
+    std::string describe() const override {
+        return "file " + path;
+    }
+};
+
+// Reads packed BGR24 frames of a fixed size from a named pipe, a raw dump
+// file or stdin ("-").
+class RawPipeSource : public FrameSource {
+private:
+    std::string path;
+    int width;
+    int height;
+    FILE* stream = nullptr;
+    bool received = false;  // Any frame read yet
+
+public:
+    RawPipeSource(const std::string& pipePath, int frameWidth, int frameHeight)
+        : path(pipePath), width(frameWidth), height(frameHeight) {}
+
+    ~RawPipeSource() override {
+        if (stream && stream != stdin) {
+            fclose(stream);
+        }
+    }
+
+    bool open() override {
+        if (width <= 0 || height <= 0) {
+            std::cerr << "Error: Raw live source needs a frame size" << std::endl;
+            return false;
+        }
+        if (path == "-") {
+            stream = stdin;
+            return true;
+        }
+
+#ifndef _WIN32
+        // Opening a FIFO blocks until a writer connects, and open() runs on
+        // the JS thread: open without waiting, then read blocking again
+        int fd = ::open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) return false;
+
+        int flags = fcntl(fd, F_GETFL);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) != 0 || !(stream = fdopen(fd, "rb"))) {
+            ::close(fd);
+            return false;
+        }
+        return true;
+#else
+        stream = fopen(path.c_str(), "rb");
+        return stream != nullptr;
+#endif
+    }
+
+    ReadStatus read(cv::Mat& frame) override {
+        frame.create(height, width, CV_8UC3);
+        size_t rowBytes = static_cast<size_t>(width) * 3;
+
+        for (int y = 0; y < height; y++) {
+            size_t count = fread(frame.ptr<uchar>(y), 1, rowBytes, stream);
+            if (count != rowBytes) {
+                // A FIFO reads as empty until its writer connects
+                if (!received && y == 0 && count == 0 && feof(stream)) {
+                    clearerr(stream);
+                    return ReadStatus::PENDING;
+                }
+                return ReadStatus::END;
+            }
+        }
+
+        received = true;
+        return ReadStatus::FRAME;
+    }
+
+    std::string describe() const override {
+        return path == "-" ? "stdin" : "pipe " + path;
+    }
+};
+
+struct LiveConfig {
+    std::vector<LineSegment> lines;
+    std::vector<RegionSpec> regions;
+    std::vector<AlarmRule> rules;
+};
+
+struct LiveLineResult {
+    std::vector<float> temperatures;
+    RegionStats stats;
+};
+
+struct LiveResult {
+    int64_t frameIndex;
+    int64_t droppedFrames;
+    double timestamp;   // Capture time, ms since epoch
+    double latencyMs;   // Capture to result
+    std::vector<LiveLineResult> lines;
+    std::vector<RegionStats> regions;
+    std::vector<AlarmEvent> alarms;
+    bool ended = false;  // The source is exhausted; no measurements
+};
+
+// Runs the configured lines and regions on each new frame using the engine's
+// lookup; included after thermal_engine.cpp
+class LiveCapture {
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // State shared with the reader thread, which may outlive stop() while it
+    // is blocked in a pipe read
+    struct Shared {
+        std::unique_ptr<FrameSource> source;
+        std::atomic<bool> running{false};
+        std::mutex frameMutex;
+        std::condition_variable frameReady;
+        cv::Mat latestFrame;
+        int64_t latestIndex = -1;
+        int64_t droppedFrames = 0;
+        Clock::time_point capturedAt;
+        double capturedEpochMs = 0;
+        bool sourceEnded = false;
+    };
+
+    static constexpr int POLL_INTERVAL_MS = 20;
+
+    ThermalEngine& engine;
+    std::shared_ptr<Shared> shared;
+    std::thread readerThread;
+    std::thread analysisThread;
+    std::mutex configMutex;
+    LiveConfig config;
+    AlarmPlan alarmPlan;
+    std::vector<float> alarmValues;
+    std::vector<AlarmEvent> undeliveredAlarms;  // From dropped results; analysis thread only
+    std::function<bool(LiveResult*)> onResult;
+
+    // Keep only the most recent frame so latency stays bounded when analysis
+    // is slower than capture
+    static void readLoop(std::shared_ptr<Shared> state) {
+        int64_t index = 0;
+
+        while (state->running) {
+            cv::Mat frame;
+            frame.allocator = numa::largeBufferAllocator();
+            ReadStatus status = state->source->read(frame);
+
+            if (status == ReadStatus::PENDING) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(POLL_INTERVAL_MS));
+                continue;
+            }
+
+            std::lock_guard<std::mutex> lock(state->frameMutex);
+            if (status == ReadStatus::END) {
+                state->sourceEnded = true;
+                state->frameReady.notify_all();
+                break;
+            }
+
+            if (!state->latestFrame.empty()) {
+                state->droppedFrames++;
+            }
+            state->latestFrame = frame;
+            state->latestIndex = index++;
+            state->capturedAt = Clock::now();
+            state->capturedEpochMs = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count());
+            state->frameReady.notify_all();
+        }
+    }
+
+    void analysisLoop() {
+        Frame analysisFrame;  // Planar buffers are reused across frames
+
+        while (shared->running) {
+            cv::Mat frame;
+            LiveResult* result = new LiveResult();
+            Clock::time_point capturedAt;
+
+            {
+                std::unique_lock<std::mutex> lock(shared->frameMutex);
+                shared->frameReady.wait(lock, [this] {
+                    return !shared->running || shared->sourceEnded || !shared->latestFrame.empty();
+                });
+
+                if (shared->latestFrame.empty()) {
+                    delete result;
+                    break;
+                }
+
+                frame = shared->latestFrame;
+                shared->latestFrame = cv::Mat();
+                result->frameIndex = shared->latestIndex;
+                result->droppedFrames = shared->droppedFrames;
+                result->timestamp = shared->capturedEpochMs;
+                capturedAt = shared->capturedAt;
+            }
+
+            LiveConfig current;
+            {
+                std::lock_guard<std::mutex> lock(configMutex);
+                current = config;
+            }
+
+            try {
+                engine.wrapFrame(frame, analysisFrame);
+
+                for (const auto& line : current.lines) {
+                    LiveLineResult lineResult;
+                    lineResult.temperatures = engine.sampleLine(analysisFrame, line.x1, line.y1, line.x2, line.y2);
+                    lineResult.stats = ThermalEngine::computeStats(lineResult.temperatures);
+                    result->lines.push_back(std::move(lineResult));
+                }
+
+                for (const auto& region : current.regions) {
+                    result->regions.push_back(engine.measureRegion(analysisFrame, region));
+                }
+            } catch (const std::exception& e) {
+                std::cerr << "Exception analyzing live frame: " << e.what() << std::endl;
+                delete result;
+                continue;
+            }
+
+            evaluateAlarms(*result);
+
+            // Alarm events are edge-triggered: those of a dropped result go
+            // out with the next one instead of being lost
+            if (!undeliveredAlarms.empty()) {
+                result->alarms.insert(result->alarms.begin(), undeliveredAlarms.begin(), undeliveredAlarms.end());
+                undeliveredAlarms.clear();
+            }
+            std::vector<AlarmEvent> alarms = result->alarms;
+
+            result->latencyMs = std::chrono::duration<double, std::milli>(Clock::now() - capturedAt).count();
+            if (!onResult(result)) {
+                undeliveredAlarms = std::move(alarms);
+            }
+        }
+
+        // Tell the receiver when the source ran out; not after stop()
+        LiveResult* ended = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(shared->frameMutex);
+            if (shared->running && shared->sourceEnded) {
+                ended = new LiveResult();
+                ended->frameIndex = shared->latestIndex;
+                ended->droppedFrames = shared->droppedFrames;
+                ended->timestamp = shared->capturedEpochMs;
+                ended->latencyMs = 0;
+                ended->ended = true;
+            }
+            shared->running = false;
+        }
+        if (ended) {
+            onResult(ended);
+        }
+    }
+
+    // Feed [min, max, avg] of every line and ROI to the compiled alarm plan
+    void evaluateAlarms(LiveResult& result) {
+        std::lock_guard<std::mutex> lock(configMutex);
+        if (alarmPlan.empty()) return;
+
+        alarmValues.clear();
+        auto append = [this](const RegionStats& stats) {
+            float nan = std::numeric_limits<float>::quiet_NaN();
+            alarmValues.push_back(stats.count > 0 ? stats.min : nan);
+            alarmValues.push_back(stats.count > 0 ? stats.max : nan);
+            alarmValues.push_back(stats.count > 0 ? stats.avg : nan);
+        };
+
+        for (const auto& line : result.lines) append(line.stats);
+        for (const auto& region : result.regions) append(region);
+
+        alarmPlan.evaluate(alarmValues, result.frameIndex, result.timestamp, result.alarms);
+    }
+
+public:
+    explicit LiveCapture(ThermalEngine& thermalEngine) : engine(thermalEngine) {}
+
+    ~LiveCapture() {
+        stop();
+    }
+
+    // onResult runs on the analysis thread and takes ownership of the result;
+    // it returns false if the result was dropped. When the source ends, a
+    // last result with ended set is passed; it must not be dropped.
+    bool start(std::unique_ptr<FrameSource> source, const LiveConfig& liveConfig,
+               std::function<bool(LiveResult*)> callback) {
+        stop();
+
+        if (!source->open()) {
+            std::cerr << "Error: Could not open live source: " << source->describe() << std::endl;
+            return false;
+        }
+
+        std::cout << "Live capture started on " << source->describe() << std::endl;
+
+        shared = std::make_shared<Shared>();
+        shared->source = std::move(source);
+        shared->running = true;
+        std::string ruleError = configure(liveConfig);
+        if (!ruleError.empty()) {
+            std::cerr << "Warning: " << ruleError << std::endl;
+        }
+        onResult = callback;
+        undeliveredAlarms.clear();
+
+        readerThread = std::thread(readLoop, shared);
+        analysisThread = std::thread(&LiveCapture::analysisLoop, this);
+        return true;
+    }
+
+    void stop() {
+        if (!shared) return;
+
+        {
+            std::lock_guard<std::mutex> lock(shared->frameMutex);
+            shared->running = false;
+            shared->frameReady.notify_all();
+        }
+
+        if (analysisThread.joinable()) {
+            analysisThread.join();
+        }
+        // A reader blocked on an idle pipe exits on its next read
+        if (readerThread.joinable()) {
+            readerThread.detach();
+        }
+
+        shared.reset();
+        std::cout << "Live capture stopped" << std::endl;
+    }
+
+    // Returns an error message if the alarm rules do not match the geometry;
+    // the geometry is applied either way. Unchanged rules keep their state.
+    std::string configure(const LiveConfig& liveConfig) {
+        std::lock_guard<std::mutex> lock(configMutex);
+        config = liveConfig;
+        return alarmPlan.compile(liveConfig.rules, liveConfig.lines.size(), liveConfig.regions.size());
+    }
+
+    bool isRunning() const {
+        return shared && shared->running;
+    }
+};
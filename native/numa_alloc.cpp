@@ -0,0 +1,324 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <mutex>
+#include <utility>
+#include <cstdlib>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Huge-page backed, NUMA-local allocation for large buffers (frames,
+// temperature planes) and per-node worker pinning for batch jobs.
+//
+// Buffers are placed on the node of the thread that allocates them, so
+// workers should allocate the buffers they process. On Linux transparent huge
+// pages are requested with madvise; set THERMAL_HUGETLB=1 to try explicit
+// hugetlbfs pages first. On Windows large pages need SeLockMemoryPrivilege and
+// fall back to normal pages without it.
+
+namespace numa {
+
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Buffers below this size are not worth a huge page
+static const size_t LARGE_BUFFER_THRESHOLD = 1024 * 1024;
+
+// Freed large buffers kept for reuse on each node
+static const size_t LARGE_BUFFER_POOL_SIZE = 8;
+
+struct Topology {
+    std::vector<std::vector<int>> nodeCpus;  // CPUs of each NUMA node
+
+    int nodeCount() const {
+        return nodeCpus.empty() ? 1 : static_cast<int>(nodeCpus.size());
+    }
+};
+
+#ifndef _WIN32
+// Parse a sysfs CPU list such as "0-7,16-23"
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+
+    while (std::getline(ss, range, ',')) {
+        size_t dash = range.find('-');
+        try {
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            continue;
+        }
+    }
+
+    return cpus;
+}
+#endif
+
+inline const Topology& topology() {
+    static Topology topo = [] {
+        Topology t;
+#ifdef _WIN32
+        ULONG highestNode = 0;
+        if (GetNumaHighestNodeNumber(&highestNode)) {
+            for (USHORT node = 0; node <= highestNode; node++) {
+                GROUP_AFFINITY affinity;
+                std::vector<int> cpus;
+                if (GetNumaNodeProcessorMaskEx(node, &affinity)) {
+                    for (int bit = 0; bit < 64; bit++) {
+                        if (affinity.Mask & (1ULL << bit)) {
+                            cpus.push_back(affinity.Group * 64 + bit);
+                        }
+                    }
+                }
+                t.nodeCpus.push_back(cpus);
+            }
+        }
+#else
+        for (int node = 0;; node++) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file.is_open()) break;
+
+            std::string list;
+            std::getline(file, list);
+            t.nodeCpus.push_back(parseCpuList(list));
+        }
+#endif
+        return t;
+    }();
+    return topo;
+}
+
+// NUMA node of the CPU the calling thread runs on
+inline int currentNode() {
+#ifdef _WIN32
+    PROCESSOR_NUMBER processor;
+    GetCurrentProcessorNumberEx(&processor);
+    USHORT node = 0;
+    return GetNumaProcessorNodeEx(&processor, &node) ? node : 0;
+#elif defined(SYS_getcpu)
+    unsigned cpu = 0, node = 0;
+    return syscall(SYS_getcpu, &cpu, &node, nullptr) == 0 ? static_cast<int>(node) : 0;
+#else
+    return 0;
+#endif
+}
+
+// Restrict the calling thread to the CPUs of one node
+inline bool pinCurrentThreadToNode(int node) {
+    const Topology& topo = topology();
+    if (node < 0 || node >= static_cast<int>(topo.nodeCpus.size()) || topo.nodeCpus[node].empty()) {
+        return false;
+    }
+
+#ifdef _WIN32
+    GROUP_AFFINITY affinity = {};
+    if (!GetNumaNodeProcessorMaskEx(static_cast<USHORT>(node), &affinity)) return false;
+    return SetThreadGroupAffinity(GetCurrentThread(), &affinity, nullptr) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : topo.nodeCpus[node]) {
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+inline size_t roundToHugePages(size_t bytes) {
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+// Allocate a large buffer on the calling thread's NUMA node, backed by huge
+// pages where the OS allows it. Free with freeLarge(ptr, bytes).
+inline void* allocateLarge(size_t bytes) {
+    size_t size = roundToHugePages(bytes);
+
+#ifdef _WIN32
+    DWORD node = static_cast<DWORD>(currentNode());
+    SIZE_T largePage = GetLargePageMinimum();
+
+    if (largePage > 0) {
+        SIZE_T largeSize = (size + largePage - 1) / largePage * largePage;
+        void* ptr = VirtualAllocExNuma(GetCurrentProcess(), nullptr, largeSize,
+                                       MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, node);
+        if (ptr) return ptr;
+    }
+
+    return VirtualAllocExNuma(GetCurrentProcess(), nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, node);
+#else
+    void* ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    const char* explicitPages = std::getenv("THERMAL_HUGETLB");
+    if (explicitPages && explicitPages[0] == '1') {
+        ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#endif
+
+    if (ptr == MAP_FAILED) {
+        ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) return nullptr;
+#ifdef MADV_HUGEPAGE
+        madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    }
+
+#if defined(__linux__) && defined(SYS_mbind)
+    // Prefer the allocating thread's node even if another thread touches first
+    if (topology().nodeCount() > 1) {
+        const int MPOL_PREFERRED_MODE = 1;
+        unsigned long nodeMask = 1UL << currentNode();
+        syscall(SYS_mbind, ptr, size, MPOL_PREFERRED_MODE, &nodeMask, sizeof(nodeMask) * 8, 0);
+    }
+#endif
+
+    return ptr;
+#endif
+}
+
+inline void freeLarge(void* ptr, size_t bytes) {
+    if (!ptr) return;
+#ifdef _WIN32
+    (void)bytes;
+    VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+    munmap(ptr, roundToHugePages(bytes));
+#endif
+}
+
+// Recently freed large buffers by node. Decoding a stream of equally sized
+// frames into fresh Mats then maps memory once, not once per frame.
+class LargeBufferPool {
+private:
+    std::mutex mutex;
+    std::vector<std::vector<std::pair<void*, size_t>>> buffers;  // Per node: (ptr, mapped bytes)
+
+public:
+    // Pooled buffer of bytes (rounded to huge pages) on node, or nullptr
+    void* take(size_t bytes, int node) {
+        size_t size = roundToHugePages(bytes);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (node < 0 || node >= static_cast<int>(buffers.size())) return nullptr;
+
+        auto& pool = buffers[node];
+        for (size_t i = pool.size(); i-- > 0; ) {
+            if (pool[i].second == size) {
+                void* ptr = pool[i].first;
+                pool.erase(pool.begin() + i);
+                return ptr;
+            }
+        }
+        return nullptr;
+    }
+
+    // Keep ptr for reuse; the oldest buffer of a full pool is freed
+    void give(void* ptr, size_t bytes, int node) {
+        std::pair<void*, size_t> evicted(nullptr, 0);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (node < 0) node = 0;
+            if (node >= static_cast<int>(buffers.size())) buffers.resize(node + 1);
+
+            auto& pool = buffers[node];
+            if (pool.size() >= LARGE_BUFFER_POOL_SIZE) {
+                evicted = pool.front();
+                pool.erase(pool.begin());
+            }
+            pool.push_back({ ptr, roundToHugePages(bytes) });
+        }
+        freeLarge(evicted.first, evicted.second);
+    }
+};
+
+inline LargeBufferPool& largeBufferPool() {
+    static LargeBufferPool pool;
+    return pool;
+}
+
+// cv::Mat allocator routing large buffers to allocateLarge(); small ones use
+// OpenCV's regular allocator. Set Mat::allocator before create()/read().
+// Freed buffers go back to largeBufferPool().
+class LargeBufferAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data0, size_t* step,
+                           cv::AccessFlag flags, cv::UMatUsageFlags usageFlags) const override {
+        size_t total = CV_ELEM_SIZE(type);
+        for (int i = dims - 1; i >= 0; i--) {
+            if (step) {
+                if (data0 && step[i] != CV_AUTOSTEP) {
+                    total = step[i];
+                } else {
+                    step[i] = total;
+                }
+            }
+            total *= sizes[i];
+        }
+
+        if (data0 || total < LARGE_BUFFER_THRESHOLD) {
+            return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data0, step, flags, usageFlags);
+        }
+
+        int node = currentNode();
+        uchar* data = static_cast<uchar*>(largeBufferPool().take(total, node));
+        if (!data) {
+            data = static_cast<uchar*>(allocateLarge(total));
+        }
+        if (!data) {
+            return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data0, step, flags, usageFlags);
+        }
+
+        cv::UMatData* u = new cv::UMatData(this);
+        u->data = u->origdata = data;
+        u->size = total;
+        u->userdata = reinterpret_cast<void*>(static_cast<intptr_t>(node));
+        return u;
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag, cv::UMatUsageFlags) const override {
+        return u != nullptr;
+    }
+
+    void deallocate(cv::UMatData* u) const override {
+        if (!u) return;
+        largeBufferPool().give(u->origdata, u->size, static_cast<int>(reinterpret_cast<intptr_t>(u->userdata)));
+        delete u;
+    }
+};
+
+inline cv::MatAllocator* largeBufferAllocator() {
+    static LargeBufferAllocator allocator;
+    return &allocator;
+}
+
+// Memory taken by the pixels of mat, for cache accounting: large buffers
+// are whole huge pages
+inline size_t footprint(const cv::Mat& mat) {
+    if (mat.u && mat.u->currAllocator == largeBufferAllocator()) {
+        return roundToHugePages(mat.u->size);
+    }
+    return mat.total() * mat.elemSize();
+}
+
+}  // namespace numa
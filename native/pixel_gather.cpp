@@ -0,0 +1,166 @@
+#pragma once
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "simd.cpp"
+#include "planar_frame.cpp"
+
+// Rasterized geometry compiled into flat byte offsets from the frame base,
+// so sampling a line or path is a gather loop with no per-pixel row math.
+// Offsets depend only on the frame layout and row stride, which stay the
+// same for every frame of a video: they are built once per geometry and
+// reused across frames.
+//
+// The AVX2 kernel fetches eight pixels per 32-bit gather (vpgatherdd), i.e.
+// up to three bytes beyond each sampled one:
+//   planar       R and G read on into the next plane; B is gathered three
+//                bytes early from the end of the G plane, so every read
+//                stays inside the frame buffer
+//   interleaved  one gather yields B, G, R of a pixel; geometries touching
+//                the last bytes of the frame use the scalar loop
+
+struct PixelOffsets {
+    FrameLayout layout = FrameLayout::PLANAR;
+    int width = 0;
+    int height = 0;
+    size_t rowBytes = 0;            // Planar stride or BGR row step
+    bool vectorSafe = false;        // 32-bit reads at every offset stay in the frame
+    std::vector<int32_t> offsets;   // Per pixel: y * rowBytes + x (planar) or 3 * x (interleaved)
+
+    // Offsets of pixels (inside the frame) in frame's layout
+    static PixelOffsets build(const Frame& frame, const std::vector<std::pair<int, int>>& pixels) {
+        PixelOffsets result;
+        result.layout = frame.isPlanar() ? FrameLayout::PLANAR : FrameLayout::INTERLEAVED;
+        result.width = frame.width();
+        result.height = frame.height();
+        result.rowBytes = frame.isPlanar() ? frame.planar.stride : frame.bgr.step;
+
+        size_t pixelBytes = frame.isPlanar() ? 1 : 3;
+        size_t maxOffset = 0;
+        result.offsets.resize(pixels.size());
+        for (size_t i = 0; i < pixels.size(); i++) {
+            size_t offset = static_cast<size_t>(pixels[i].second) * result.rowBytes + pixels[i].first * pixelBytes;
+            result.offsets[i] = static_cast<int32_t>(offset);
+            maxOffset = std::max(maxOffset, offset);
+        }
+
+        result.vectorSafe = frame.isPlanar() ||
+                            maxOffset + 4 <= static_cast<size_t>(frame.bgr.datalimit - frame.bgr.data);
+        return result;
+    }
+
+    // Whether the offsets address frame's pixels
+    bool matches(const Frame& frame) const {
+        FrameLayout frameLayout = frame.isPlanar() ? FrameLayout::PLANAR : FrameLayout::INTERLEAVED;
+        size_t frameRowBytes = frame.isPlanar() ? frame.planar.stride : frame.bgr.step;
+        return layout == frameLayout && rowBytes == frameRowBytes &&
+               width == frame.width() && height == frame.height();
+    }
+
+    size_t bytes() const {
+        return sizeof(PixelOffsets) + offsets.size() * sizeof(int32_t);
+    }
+
+    // Channels of every pixel into the r, g and b arrays (offsets.size() each)
+    void gather(const Frame& frame, uint8_t* r, uint8_t* g, uint8_t* b) const {
+        size_t count = offsets.size();
+        size_t i = 0;
+
+        if (layout == FrameLayout::PLANAR) {
+            const uint8_t* rPlane = frame.planar.plane(0);
+            const uint8_t* gPlane = frame.planar.plane(1);
+            const uint8_t* bPlane = frame.planar.plane(2);
+#ifdef THERMAL_X64
+            if (simd::hasAvx2()) {
+                i = gatherPlanarAvx2(rPlane, gPlane, bPlane, offsets.data(), count, r, g, b);
+            }
+#endif
+            for (; i < count; i++) {
+                r[i] = rPlane[offsets[i]];
+                g[i] = gPlane[offsets[i]];
+                b[i] = bPlane[offsets[i]];
+            }
+            return;
+        }
+
+        // OpenCV uses BGR, not RGB
+        const uint8_t* data = frame.bgr.data;
+#ifdef THERMAL_X64
+        if (vectorSafe && simd::hasAvx2()) {
+            i = gatherInterleavedAvx2(data, offsets.data(), count, r, g, b);
+        }
+#endif
+        for (; i < count; i++) {
+            const uint8_t* pixel = data + offsets[i];
+            b[i] = pixel[0];
+            g[i] = pixel[1];
+            r[i] = pixel[2];
+        }
+    }
+
+private:
+#ifdef THERMAL_X64
+    // Byte lane of each gathered dword to keep, packed into the low dword of
+    // each 128-bit half, then both halves into the low 8 bytes
+    THERMAL_TARGET_AVX2 static uint64_t packBytes(__m256i dwords, __m256i pick) {
+        const __m256i halves = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(dwords, pick), halves);
+        return static_cast<uint64_t>(_mm_cvtsi128_si64(_mm256_castsi256_si128(packed)));
+    }
+
+    THERMAL_TARGET_AVX2 static size_t gatherPlanarAvx2(const uint8_t* rPlane, const uint8_t* gPlane,
+                                                       const uint8_t* bPlane, const int32_t* offsets,
+                                                       size_t count, uint8_t* r, uint8_t* g, uint8_t* b) {
+        const __m256i lowBytes = _mm256_setr_epi8(
+            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m256i highBytes = _mm256_setr_epi8(
+            3, 7, 11, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            3, 7, 11, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+        const int* rBase = reinterpret_cast<const int*>(rPlane);
+        const int* gBase = reinterpret_cast<const int*>(gPlane);
+        const int* bBase = reinterpret_cast<const int*>(bPlane - 3);
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            __m256i offset = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + i));
+            uint64_t red = packBytes(_mm256_i32gather_epi32(rBase, offset, 1), lowBytes);
+            uint64_t green = packBytes(_mm256_i32gather_epi32(gBase, offset, 1), lowBytes);
+            uint64_t blue = packBytes(_mm256_i32gather_epi32(bBase, offset, 1), highBytes);
+            std::memcpy(r + i, &red, 8);
+            std::memcpy(g + i, &green, 8);
+            std::memcpy(b + i, &blue, 8);
+        }
+
+        return i;
+    }
+
+    THERMAL_TARGET_AVX2 static size_t gatherInterleavedAvx2(const uint8_t* data, const int32_t* offsets,
+                                                            size_t count, uint8_t* r, uint8_t* g, uint8_t* b) {
+        // B bytes to dword 0, G to dword 1, R to dword 2 of each half
+        const __m256i split = _mm256_setr_epi8(
+            0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, -1, -1, -1, -1,
+            0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, -1, -1, -1, -1);
+        const __m256i halves = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        const int* base = reinterpret_cast<const int*>(data);
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            __m256i offset = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(offsets + i));
+            __m256i pixels = _mm256_i32gather_epi32(base, offset, 1);
+            __m256i channels = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(pixels, split), halves);
+            uint64_t blue = static_cast<uint64_t>(_mm256_extract_epi64(channels, 0));
+            uint64_t green = static_cast<uint64_t>(_mm256_extract_epi64(channels, 1));
+            uint64_t red = static_cast<uint64_t>(_mm256_extract_epi64(channels, 2));
+            std::memcpy(r + i, &red, 8);
+            std::memcpy(g + i, &green, 8);
+            std::memcpy(b + i, &blue, 8);
+        }
+
+        return i;
+    }
+#endif
+};
@@ -0,0 +1,147 @@
+#pragma once
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "numa_alloc.cpp"
+
+// Structure-of-arrays frame: separate R, G and B planes with 64-byte aligned
+// rows, so the conversion kernels load each channel with plain vector loads
+// instead of de-interleaving BGR triplets per pixel.
+
+static const size_t PLANE_ALIGNMENT = 64;
+
+enum class FrameLayout : int {
+    INTERLEAVED = 0,  // OpenCV BGR as decoded
+    PLANAR = 1        // PlanarFrame
+};
+
+class PlanarFrame {
+private:
+    std::shared_ptr<uint8_t> buffer;  // R, G and B planes back to back
+    size_t bufferBytes = 0;
+    size_t allocatedBytes = 0;        // bufferBytes rounded to huge pages if large
+
+    // Large buffers come from and go back to numa::largeBufferPool()
+    static std::shared_ptr<uint8_t> allocate(size_t bytes, size_t& allocated) {
+        if (bytes >= numa::LARGE_BUFFER_THRESHOLD) {
+            int node = numa::currentNode();
+            void* data = numa::largeBufferPool().take(bytes, node);
+            if (!data) {
+                data = numa::allocateLarge(bytes);
+            }
+            if (data) {
+                allocated = numa::roundToHugePages(bytes);
+                return std::shared_ptr<uint8_t>(static_cast<uint8_t*>(data),
+                    [bytes, node](uint8_t* p) { numa::largeBufferPool().give(p, bytes, node); });
+            }
+        }
+        // fastMalloc aligns to at least 64 bytes
+        allocated = bytes;
+        return std::shared_ptr<uint8_t>(static_cast<uint8_t*>(cv::fastMalloc(bytes)),
+                                        [](uint8_t* p) { cv::fastFree(p); });
+    }
+
+public:
+    int width = 0;
+    int height = 0;
+    size_t stride = 0;  // Bytes per row, a multiple of PLANE_ALIGNMENT
+
+    bool empty() const { return !buffer; }
+    size_t bytes() const { return allocatedBytes; }
+
+    // Plane 0 is red, 1 green, 2 blue
+    const uint8_t* plane(int channel) const {
+        return buffer.get() + static_cast<size_t>(channel) * stride * height;
+    }
+
+    uint8_t* plane(int channel) {
+        return buffer.get() + static_cast<size_t>(channel) * stride * height;
+    }
+
+    // De-interleave a BGR frame. The buffer is reused when this frame owns it
+    // exclusively and the size matches, so streaming loops do not reallocate.
+    void assign(const cv::Mat& bgr) {
+        CV_Assert(bgr.type() == CV_8UC3);
+
+        size_t rowStride = (static_cast<size_t>(bgr.cols) + PLANE_ALIGNMENT - 1) / PLANE_ALIGNMENT * PLANE_ALIGNMENT;
+        size_t total = rowStride * bgr.rows * 3;
+
+        if (!buffer || buffer.use_count() != 1 || total != bufferBytes) {
+            buffer = allocate(total, allocatedBytes);
+            bufferBytes = total;
+        }
+        width = bgr.cols;
+        height = bgr.rows;
+        stride = rowStride;
+
+        // cv::split keeps destination buffers of matching size and type
+        std::vector<cv::Mat> planes = {
+            cv::Mat(height, width, CV_8UC1, plane(2), stride),
+            cv::Mat(height, width, CV_8UC1, plane(1), stride),
+            cv::Mat(height, width, CV_8UC1, plane(0), stride)
+        };
+        cv::split(bgr, planes);
+
+        for (int c = 0; c < 3; c++) {
+            uint8_t* expected = plane(2 - c);
+            if (planes[c].data != expected) {
+                cv::Mat target(height, width, CV_8UC1, expected, stride);
+                planes[c].copyTo(target);
+            }
+        }
+    }
+
+    static PlanarFrame fromBgr(const cv::Mat& bgr) {
+        PlanarFrame frame;
+        frame.assign(bgr);
+        return frame;
+    }
+
+    // Interleave back to BGR, e.g. for JPEG encoding
+    cv::Mat toBgr() const {
+        cv::Mat bgr;
+        if (empty()) return bgr;
+
+        std::vector<cv::Mat> planes = {
+            cv::Mat(height, width, CV_8UC1, const_cast<uint8_t*>(plane(2)), stride),
+            cv::Mat(height, width, CV_8UC1, const_cast<uint8_t*>(plane(1)), stride),
+            cv::Mat(height, width, CV_8UC1, const_cast<uint8_t*>(plane(0)), stride)
+        };
+        cv::merge(planes, bgr);
+        return bgr;
+    }
+};
+
+// A decoded frame in the engine's analysis layout; exactly one of the two
+// representations is set. Copies share pixel data.
+struct Frame {
+    cv::Mat bgr;
+    PlanarFrame planar;
+
+    bool empty() const { return bgr.empty() && planar.empty(); }
+    bool isPlanar() const { return !planar.empty(); }
+    int width() const { return isPlanar() ? planar.width : bgr.cols; }
+    int height() const { return isPlanar() ? planar.height : bgr.rows; }
+
+    size_t bytes() const {
+        return isPlanar() ? planar.bytes() : numa::footprint(bgr);
+    }
+
+    // BGR view for encoding; converts planar frames
+    cv::Mat toBgr() const {
+        return isPlanar() ? planar.toBgr() : bgr;
+    }
+
+    // Store a decoded BGR frame in the requested layout, reusing buffers
+    void assign(const cv::Mat& decoded, FrameLayout layout) {
+        if (layout == FrameLayout::PLANAR) {
+            planar.assign(decoded);
+            bgr.release();
+        } else {
+            bgr = decoded;
+            planar = PlanarFrame();
+        }
+    }
+};
@@ -0,0 +1,167 @@
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// Lossless compression of streamed line profiles at 0.1 °C resolution
+// (U16_DECI samples). The first profile of a stream, and any profile whose
+// length differs from the previous one, is sent raw; later profiles are sent
+// as per-sample differences to the previous profile, zigzag mapped and Rice
+// coded with one parameter per block of samples.
+//
+//   uint8  type (PROFILE_KEY or PROFILE_DELTA)
+//   uint32 sample count, little endian
+//   KEY:   count uint16 little endian
+//   DELTA: per block of PROFILE_BLOCK samples one 4-bit Rice parameter k,
+//          then per sample: quotient in unary (ones, then a zero) and k
+//          remainder bits; a quotient of PROFILE_ESCAPE ones is followed by
+//          the 17-bit zigzag value instead. Bits are MSB first.
+//
+// Temperature tiles use the same coding spatially: the first row is a key
+// frame and every further row is a delta frame against the row above.
+//
+// The browser decoder is public/profile-codec.js.
+
+namespace profilecodec {
+
+static const uint8_t PROFILE_KEY = 0;
+static const uint8_t PROFILE_DELTA = 1;
+static const size_t PROFILE_BLOCK = 64;
+static const uint32_t PROFILE_ESCAPE = 24;
+static const int ZIGZAG_BITS = 17;
+
+class BitWriter {
+private:
+    std::vector<uint8_t>& out;
+    uint64_t accumulator = 0;
+    int pending = 0;
+
+public:
+    explicit BitWriter(std::vector<uint8_t>& buffer) : out(buffer) {}
+
+    void put(uint32_t value, int bits) {
+        accumulator = (accumulator << bits) | (value & ((1ULL << bits) - 1));
+        pending += bits;
+        while (pending >= 8) {
+            pending -= 8;
+            out.push_back(static_cast<uint8_t>(accumulator >> pending));
+        }
+    }
+
+    void ones(uint32_t count) {
+        for (; count >= 16; count -= 16) put(0xFFFF, 16);
+        if (count) put((1u << count) - 1, static_cast<int>(count));
+    }
+
+    void flush() {
+        if (pending > 0) {
+            out.push_back(static_cast<uint8_t>(accumulator << (8 - pending)));
+            pending = 0;
+        }
+    }
+};
+
+inline uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+inline size_t riceBits(uint32_t value, int k) {
+    uint32_t quotient = value >> k;
+    return quotient >= PROFILE_ESCAPE ? PROFILE_ESCAPE + ZIGZAG_BITS : quotient + 1 + k;
+}
+
+// Cheapest Rice parameter for a block
+inline int chooseParameter(const uint32_t* values, size_t count) {
+    int bestK = 0;
+    size_t bestBits = SIZE_MAX;
+
+    for (int k = 0; k < 16; k++) {
+        size_t bits = 0;
+        for (size_t i = 0; i < count; i++) {
+            bits += riceBits(values[i], k);
+        }
+        if (bits < bestBits) {
+            bestBits = bits;
+            bestK = k;
+        }
+    }
+
+    return bestK;
+}
+
+// Encode current against previous (nullptr or a different length: key frame)
+inline std::vector<uint8_t> encode(const uint16_t* current, size_t count,
+                                   const uint16_t* previous, size_t previousCount) {
+    std::vector<uint8_t> out;
+    bool key = previous == nullptr || previousCount != count;
+
+    out.push_back(key ? PROFILE_KEY : PROFILE_DELTA);
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(count >> shift));
+    }
+
+    if (key) {
+        for (size_t i = 0; i < count; i++) {
+            out.push_back(static_cast<uint8_t>(current[i]));
+            out.push_back(static_cast<uint8_t>(current[i] >> 8));
+        }
+        return out;
+    }
+
+    out.reserve(out.size() + count / 2);
+    BitWriter writer(out);
+    uint32_t residuals[PROFILE_BLOCK];
+
+    for (size_t start = 0; start < count; start += PROFILE_BLOCK) {
+        size_t length = std::min(PROFILE_BLOCK, count - start);
+        for (size_t i = 0; i < length; i++) {
+            residuals[i] = zigzag(static_cast<int32_t>(current[start + i]) - previous[start + i]);
+        }
+
+        int k = chooseParameter(residuals, length);
+        writer.put(static_cast<uint32_t>(k), 4);
+
+        for (size_t i = 0; i < length; i++) {
+            uint32_t quotient = residuals[i] >> k;
+            if (quotient >= PROFILE_ESCAPE) {
+                writer.ones(PROFILE_ESCAPE);
+                writer.put(residuals[i], ZIGZAG_BITS);
+            } else {
+                writer.ones(quotient);
+                writer.put(0, 1);
+                if (k) writer.put(residuals[i], k);
+            }
+        }
+    }
+
+    writer.flush();
+    return out;
+}
+
+// Encode the w x h tile at (x, y) of a 0.1 °C plane:
+//   uint32 byte length of the first row, first row (key), rows 1.. (delta)
+inline std::vector<uint8_t> encodeTile(const uint16_t* plane, size_t planeWidth, int x, int y, int w, int h) {
+    std::vector<uint16_t> tile(static_cast<size_t>(w) * h);
+    for (int row = 0; row < h; row++) {
+        const uint16_t* source = plane + static_cast<size_t>(y + row) * planeWidth + x;
+        std::copy(source, source + w, tile.begin() + static_cast<size_t>(row) * w);
+    }
+
+    std::vector<uint8_t> first = encode(tile.data(), w, nullptr, 0);
+    std::vector<uint8_t> out;
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(first.size() >> shift));
+    }
+    out.insert(out.end(), first.begin(), first.end());
+
+    if (h > 1) {
+        size_t rest = static_cast<size_t>(w) * (h - 1);
+        std::vector<uint8_t> rows = encode(tile.data() + w, rest, tile.data(), rest);
+        out.insert(out.end(), rows.begin(), rows.end());
+    }
+
+    return out;
+}
+
+}  // namespace profilecodec
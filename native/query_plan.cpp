@@ -0,0 +1,402 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include "geometry.cpp"
+
+// Batched analysis queries: a list of geometries and a list of outputs,
+// each reducing one geometry on every frame the query is run on. A query is
+// compiled once into a plan holding the union of all geometry pixels
+// (rasterized once, each pixel once); running the plan fetches and converts
+// every frame once for all outputs. Plans do not depend on the frames, so a
+// prepared plan is run again on each new frame without recompiling.
+
+enum class QueryGeometryType : uint8_t { POINT, LINE, PATH, REGION };
+enum class QueryReducer : uint8_t { PROFILE, STATS, HISTOGRAM, KYMOGRAPH };
+
+// Values per frame of a STATS output: min, max, avg, count
+static constexpr int QUERY_STATS_VALUES = 4;
+
+static const size_t MAX_QUERY_GEOMETRIES = 64;
+static const size_t MAX_QUERY_OUTPUTS = 64;
+static const size_t MAX_QUERY_FRAMES = 3600;
+static const size_t MAX_QUERY_PIXELS = static_cast<size_t>(1) << 22;
+static const size_t MAX_QUERY_VALUES = static_cast<size_t>(1) << 24;  // Floats over all outputs and frames
+static const int MAX_HISTOGRAM_BINS = 1024;
+static const int MAX_KYMOGRAPH_WIDTH = 4096;
+static const size_t MAX_PREPARED_QUERIES = 4096;
+
+// A point (line.x1, line.y1), line, path or region in video pixel coordinates
+struct QueryGeometry {
+    QueryGeometryType type = QueryGeometryType::LINE;
+    LineSegment line{ 0, 0, 0, 0 };
+    PathSpec path;
+    RegionSpec region{ 0, 0, 0, 0 };
+};
+
+// One geometry reduced on every frame of the query
+struct QueryOutput {
+    QueryReducer reducer = QueryReducer::PROFILE;
+    int geometry = 0;
+    int bins = 32;            // HISTOGRAM: equal bins over [low, high)
+    float low = 0;
+    float high = 2000;
+    int width = 0;            // KYMOGRAPH: columns per row, 0 for the full profile
+};
+
+struct QuerySpec {
+    std::vector<QueryGeometry> geometries;
+    std::vector<QueryOutput> outputs;
+    int level = 0;            // Pyramid level lines and paths are rasterized on
+};
+
+// Results of one output: a row of cols values per frame of the query
+struct QueryMatrix {
+    int rows = 0;
+    int cols = 0;
+    std::vector<float> values;
+};
+
+struct QueryResult {
+    std::vector<uint8_t> valid;         // Per frame; rows of failed frames stay 0
+    std::vector<QueryMatrix> outputs;
+};
+
+// Cache key of a compiled query: every field of the spec and the frame size
+inline uint64_t queryHash(const QuerySpec& spec, int width, int height) {
+    uint64_t key = 1469598103934665603ULL;  // FNV-1a
+    auto mix = [&](uint32_t value) { key = (key ^ value) * 1099511628211ULL; };
+    auto mixFloat = [&](float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        mix(bits);
+    };
+
+    mix(static_cast<uint32_t>(width));
+    mix(static_cast<uint32_t>(height));
+    mix(static_cast<uint32_t>(spec.level));
+
+    for (const QueryGeometry& geometry : spec.geometries) {
+        mix(static_cast<uint32_t>(geometry.type));
+        if (geometry.type == QueryGeometryType::PATH) {
+            uint64_t path = pathHash(geometry.path, width, height, spec.level);
+            mix(static_cast<uint32_t>(path));
+            mix(static_cast<uint32_t>(path >> 32));
+        } else if (geometry.type == QueryGeometryType::REGION) {
+            const RegionSpec& region = geometry.region;
+            const int fields[4] = { region.x, region.y, region.width, region.height };
+            for (int field : fields) mix(static_cast<uint32_t>(field));
+        } else {
+            const LineSegment& line = geometry.line;
+            const int fields[4] = { line.x1, line.y1, line.x2, line.y2 };
+            for (int field : fields) mix(static_cast<uint32_t>(field));
+        }
+    }
+
+    mix(0xFFFFFFFFu);  // Geometries and outputs cannot run into each other
+    for (const QueryOutput& output : spec.outputs) {
+        mix(static_cast<uint32_t>(output.reducer));
+        mix(static_cast<uint32_t>(output.geometry));
+        mix(static_cast<uint32_t>(output.bins));
+        mixFloat(output.low);
+        mixFloat(output.high);
+        mix(static_cast<uint32_t>(output.width));
+    }
+
+    return key;
+}
+
+class QueryPlan {
+public:
+    std::vector<QueryOutput> outputs;
+    std::vector<int> columns;                    // Values per frame of each output
+    std::vector<std::pair<int, int>> pixels;     // Union of all geometries, row-major
+    std::vector<std::vector<uint32_t>> samples;  // Per geometry: indices into pixels
+    size_t rowValues = 0;                        // Sum of columns
+    int width = 0;                               // Frame size the plan was compiled for
+    int height = 0;
+    uint64_t key = 0;                            // Cache key (see queryHash), set by the engine
+
+    // Compile a query for a width x height video; returns an error message
+    // on failure and leaves the plan empty
+    std::string compile(const QuerySpec& spec, int frameWidth, int frameHeight) {
+        clear();
+        std::string error = rasterize(spec, frameWidth, frameHeight);
+        if (error.empty()) {
+            error = layout(spec);
+        }
+        if (!error.empty()) {
+            clear();
+            return error;
+        }
+        width = frameWidth;
+        height = frameHeight;
+        return error;
+    }
+
+    // A plan prepared for another video must not be run on this one
+    bool fits(int frameWidth, int frameHeight) const {
+        return width == frameWidth && height == frameHeight;
+    }
+
+    // Largest number of frames one run may cover
+    size_t maxFrames() const {
+        return rowValues > 0 ? std::min(MAX_QUERY_FRAMES, MAX_QUERY_VALUES / rowValues) : MAX_QUERY_FRAMES;
+    }
+
+    // Zeroed result for frameCount frames, filled row by row by reduce
+    QueryResult emptyResult(size_t frameCount) const {
+        QueryResult result;
+        result.valid.assign(frameCount, 0);
+        result.outputs.resize(outputs.size());
+        for (size_t o = 0; o < outputs.size(); o++) {
+            QueryMatrix& matrix = result.outputs[o];
+            matrix.rows = static_cast<int>(frameCount);
+            matrix.cols = columns[o];
+            matrix.values.assign(static_cast<size_t>(matrix.rows) * matrix.cols, 0.0f);
+        }
+        return result;
+    }
+
+    // Reduce the temperatures of pixels (converted for one frame) into row
+    // frameIndex of every output; gathered is scratch space
+    void reduce(const std::vector<float>& temps, size_t frameIndex, std::vector<QueryMatrix>& results,
+                std::vector<float>& gathered) const {
+        for (size_t o = 0; o < outputs.size(); o++) {
+            const QueryOutput& output = outputs[o];
+            const std::vector<uint32_t>& indices = samples[output.geometry];
+            float* row = results[o].values.data() + frameIndex * columns[o];
+
+            gathered.resize(indices.size());
+            for (size_t i = 0; i < indices.size(); i++) {
+                gathered[i] = temps[indices[i]];
+            }
+
+            switch (output.reducer) {
+                case QueryReducer::PROFILE:
+                    std::copy(gathered.begin(), gathered.end(), row);
+                    break;
+                case QueryReducer::STATS:
+                    reduceStats(gathered, row);
+                    break;
+                case QueryReducer::HISTOGRAM:
+                    reduceHistogram(gathered, output, row);
+                    break;
+                case QueryReducer::KYMOGRAPH:
+                    reduceColumns(gathered, columns[o], row);
+                    break;
+            }
+        }
+    }
+
+    size_t bytes() const {
+        size_t total = sizeof(QueryPlan) + pixels.size() * sizeof(std::pair<int, int>) +
+                       columns.size() * sizeof(int) + outputs.size() * sizeof(QueryOutput);
+        for (const auto& indices : samples) {
+            total += sizeof(indices) + indices.size() * sizeof(uint32_t);
+        }
+        return total;
+    }
+
+private:
+    void clear() {
+        outputs.clear();
+        columns.clear();
+        pixels.clear();
+        samples.clear();
+        rowValues = 0;
+        width = 0;
+        height = 0;
+    }
+
+    // Pixels of every geometry, merged into the union so that a pixel shared
+    // by several geometries is converted once per frame
+    std::string rasterize(const QuerySpec& spec, int width, int height) {
+        std::unordered_map<uint64_t, uint32_t> unionIndex;
+        std::vector<std::pair<int, int>> geometryPixels;
+        int level = spec.level;
+        int levelWidth = (width + (1 << level) - 1) >> level;
+        int levelHeight = (height + (1 << level) - 1) >> level;
+
+        for (size_t g = 0; g < spec.geometries.size(); g++) {
+            const QueryGeometry& geometry = spec.geometries[g];
+            geometryPixels.clear();
+
+            if (geometry.type == QueryGeometryType::POINT) {
+                const LineSegment& point = geometry.line;
+                if (point.x1 >= 0 && point.x1 < width && point.y1 >= 0 && point.y1 < height) {
+                    geometryPixels.push_back({ point.x1, point.y1 });
+                }
+            } else if (geometry.type == QueryGeometryType::LINE) {
+                const LineSegment& line = geometry.line;
+                LineSpan span;
+                if (clipLine(line.x1 >> level, line.y1 >> level, line.x2 >> level, line.y2 >> level,
+                             levelWidth, levelHeight, span)) {
+                    walkLineSpan(span, [&](int x, int y) {
+                        geometryPixels.push_back({ x << level, y << level });
+                    });
+                }
+            } else if (geometry.type == QueryGeometryType::PATH) {
+                geometryPixels = rasterizePath(geometry.path, width, height, level);
+                if (geometryPixels.size() >= MAX_PATH_SAMPLES) {
+                    return "Path " + std::to_string(g) + " has too many samples";
+                }
+            } else {
+                const RegionSpec& region = geometry.region;
+                int x0 = std::max(0, region.x);
+                int y0 = std::max(0, region.y);
+                int x1 = std::min(width, region.x + region.width);
+                int y1 = std::min(height, region.y + region.height);
+                if (x1 > x0 && y1 > y0 &&
+                    static_cast<size_t>(x1 - x0) * (y1 - y0) > MAX_QUERY_PIXELS) {
+                    return "Region " + std::to_string(g) + " is too large";
+                }
+                for (int y = y0; y < y1; y++) {
+                    for (int x = x0; x < x1; x++) {
+                        geometryPixels.push_back({ x, y });
+                    }
+                }
+            }
+
+            std::vector<uint32_t> indices;
+            indices.reserve(geometryPixels.size());
+            for (const auto& pixel : geometryPixels) {
+                uint64_t key = (static_cast<uint64_t>(pixel.second) << 32) | static_cast<uint32_t>(pixel.first);
+                auto inserted = unionIndex.emplace(key, static_cast<uint32_t>(pixels.size()));
+                if (inserted.second) {
+                    pixels.push_back(pixel);
+                }
+                indices.push_back(inserted.first->second);
+            }
+            samples.push_back(std::move(indices));
+
+            if (pixels.size() > MAX_QUERY_PIXELS) {
+                return "Query covers more than " + std::to_string(MAX_QUERY_PIXELS) + " pixels";
+            }
+        }
+
+        // Convert the union in row-major order for locality, then remap
+        std::vector<uint32_t> sorted(pixels.size());
+        std::iota(sorted.begin(), sorted.end(), 0);
+        std::sort(sorted.begin(), sorted.end(), [&](uint32_t a, uint32_t b) {
+            return pixels[a].second != pixels[b].second ? pixels[a].second < pixels[b].second
+                                                        : pixels[a].first < pixels[b].first;
+        });
+
+        std::vector<uint32_t> remap(pixels.size());
+        std::vector<std::pair<int, int>> ordered(pixels.size());
+        for (size_t i = 0; i < sorted.size(); i++) {
+            remap[sorted[i]] = static_cast<uint32_t>(i);
+            ordered[i] = pixels[sorted[i]];
+        }
+        pixels.swap(ordered);
+
+        for (auto& indices : samples) {
+            for (uint32_t& index : indices) {
+                index = remap[index];
+            }
+        }
+
+        return "";
+    }
+
+    std::string layout(const QuerySpec& spec) {
+        for (size_t o = 0; o < spec.outputs.size(); o++) {
+            const QueryOutput& output = spec.outputs[o];
+            if (output.geometry < 0 || static_cast<size_t>(output.geometry) >= samples.size()) {
+                return "Output " + std::to_string(o) + " references a missing geometry";
+            }
+
+            size_t length = samples[output.geometry].size();
+            int cols = 0;
+            switch (output.reducer) {
+                case QueryReducer::PROFILE:
+                    cols = static_cast<int>(length);
+                    break;
+                case QueryReducer::STATS:
+                    cols = QUERY_STATS_VALUES;
+                    break;
+                case QueryReducer::HISTOGRAM:
+                    if (output.bins < 1 || output.bins > MAX_HISTOGRAM_BINS || !(output.high > output.low)) {
+                        return "Output " + std::to_string(o) + " needs 1 to " +
+                               std::to_string(MAX_HISTOGRAM_BINS) + " bins over a non-empty range";
+                    }
+                    cols = output.bins;
+                    break;
+                case QueryReducer::KYMOGRAPH:
+                    if (output.width < 0 || output.width > MAX_KYMOGRAPH_WIDTH) {
+                        return "Output " + std::to_string(o) + " width must be between 0 and " +
+                               std::to_string(MAX_KYMOGRAPH_WIDTH);
+                    }
+                    cols = output.width > 0 ? static_cast<int>(std::min(length, static_cast<size_t>(output.width)))
+                                            : static_cast<int>(length);
+                    break;
+            }
+
+            rowValues += static_cast<size_t>(cols);
+            if (rowValues > MAX_QUERY_VALUES) {
+                return "Query results would exceed " + std::to_string(MAX_QUERY_VALUES) + " values per frame";
+            }
+
+            outputs.push_back(output);
+            columns.push_back(cols);
+        }
+
+        return "";
+    }
+
+    static void reduceStats(const std::vector<float>& temps, float* row) {
+        float min = 0;
+        float max = 0;
+        double sum = 0;
+        int count = 0;
+
+        for (float t : temps) {
+            if (t <= 0) continue;
+            if (count == 0 || t < min) min = t;
+            if (count == 0 || t > max) max = t;
+            sum += t;
+            count++;
+        }
+
+        row[0] = min;
+        row[1] = max;
+        row[2] = count > 0 ? static_cast<float>(sum / count) : 0.0f;
+        row[3] = static_cast<float>(count);
+    }
+
+    // Counts of valid samples per bin; samples outside [low, high) are not counted
+    static void reduceHistogram(const std::vector<float>& temps, const QueryOutput& output, float* row) {
+        std::fill(row, row + output.bins, 0.0f);
+        float scale = output.bins / (output.high - output.low);
+
+        for (float t : temps) {
+            if (t <= 0 || t < output.low || t >= output.high) continue;
+            int bin = std::min(output.bins - 1, static_cast<int>((t - output.low) * scale));
+            row[bin] += 1.0f;
+        }
+    }
+
+    // Mean of the valid samples of each of cols equal ranges (0 if none)
+    static void reduceColumns(const std::vector<float>& temps, int cols, float* row) {
+        for (int c = 0; c < cols; c++) {
+            size_t start = static_cast<size_t>(c) * temps.size() / cols;
+            size_t end = static_cast<size_t>(c + 1) * temps.size() / cols;
+            double sum = 0;
+            int count = 0;
+
+            for (size_t i = start; i < end; i++) {
+                if (temps[i] <= 0) continue;
+                sum += temps[i];
+                count++;
+            }
+
+            row[c] = count > 0 ? static_cast<float>(sum / count) : 0.0f;
+        }
+    }
+};
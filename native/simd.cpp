@@ -0,0 +1,75 @@
+#pragma once
+
+// Runtime CPU feature dispatch for the vectorized kernels. SIMD functions are
+// compiled for their instruction set with THERMAL_TARGET_* (GCC/Clang) and
+// only called after the matching simd::has*() check, so the addon still runs
+// on CPUs without them.
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define THERMAL_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// Some kernels use intrinsics that only exist in 64-bit mode
+#if defined(__x86_64__) || defined(_M_X64)
+#define THERMAL_X64 1
+#endif
+
+#if defined(THERMAL_X86) && (defined(__GNUC__) || defined(__clang__))
+#define THERMAL_TARGET_AVX2 __attribute__((target("avx2")))
+#define THERMAL_TARGET_AVX2_F16C __attribute__((target("avx2,f16c")))
+#else
+#define THERMAL_TARGET_AVX2
+#define THERMAL_TARGET_AVX2_F16C
+#endif
+
+namespace simd {
+
+#ifdef THERMAL_X86
+struct CpuFeatures {
+    bool avx2 = false;
+    bool f16c = false;
+
+    CpuFeatures() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 1);
+        bool osxsave = (info[2] & (1 << 27)) != 0;
+        bool avx = (info[2] & (1 << 28)) != 0;
+        f16c = (info[2] & (1 << 29)) != 0;
+
+        // The OS must save YMM registers on context switches
+        bool ymmEnabled = osxsave && (_xgetbv(0) & 0x6) == 0x6;
+
+        __cpuidex(info, 7, 0);
+        avx2 = ymmEnabled && avx && (info[1] & (1 << 5)) != 0;
+        f16c = f16c && ymmEnabled;
+#else
+        __builtin_cpu_init();
+        avx2 = __builtin_cpu_supports("avx2");
+        f16c = avx2 && __builtin_cpu_supports("avx");
+#ifdef __GNUC__
+        unsigned eax, ebx, ecx, edx;
+        __asm__ volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1), "c"(0));
+        f16c = f16c && (ecx & (1u << 29)) != 0;
+#endif
+#endif
+    }
+};
+
+inline const CpuFeatures& features() {
+    static CpuFeatures cpu;
+    return cpu;
+}
+
+inline bool hasAvx2() { return features().avx2; }
+inline bool hasF16c() { return features().f16c; }
+#else
+inline bool hasAvx2() { return false; }
+inline bool hasF16c() { return false; }
+#endif
+
+}  // namespace simd
@@ -0,0 +1,383 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#define THERMAL_STREAM_IO
+#endif
+
+// Streaming I/O for one-shot batch passes (envelope builds and scoring,
+// volume export). Such a pass touches every byte of a file once; through the
+// page cache it would evict what the interactive server keeps hot. On Linux
+// batch passes therefore stream past the cache:
+//   StreamingRead   recordings decoded by OpenCV: pages the decoder has
+//                   passed are dropped with posix_fadvise(DONTNEED), except
+//                   pages that were cached before the pass started
+//   StreamWriter    sequential output written with O_DIRECT from two
+//                   aligned buffers, one filled while the other is written;
+//                   where O_DIRECT is refused (tmpfs, some network file
+//                   systems) written ranges are flushed and dropped instead
+// Set THERMAL_CACHED_SCANS=1 to leave batch I/O to the page cache.
+
+static const size_t STREAM_ALIGNMENT = 4096;
+static const size_t STREAM_BUFFER_BYTES = 8 * 1024 * 1024;
+
+// Pages are released this far behind the estimated read position, which
+// leaves the decoder's own read-ahead alone; and in chunks of at least
+// STREAM_RELEASE_CHUNK to keep the fadvise calls rare
+static const uint64_t STREAM_RELEASE_LAG = 32 * 1024 * 1024;
+static const uint64_t STREAM_RELEASE_CHUNK = 8 * 1024 * 1024;
+
+inline bool cachedScans() {
+    static const bool cached = [] {
+        const char* setting = std::getenv("THERMAL_CACHED_SCANS");
+        return setting && setting[0] == '1';
+    }();
+    return cached;
+}
+
+// Drops the pages of a file behind a reader that goes through it once from
+// start to end. Releasing a page the reader still needs only costs a reread.
+class StreamingRead {
+private:
+    int fd = -1;
+    uint64_t size = 0;
+    uint64_t released = 0;
+    uint64_t pageSize = STREAM_ALIGNMENT;
+    std::vector<unsigned char> resident;  // Per page, when the pass started
+
+    void release(uint64_t end) {
+#ifdef THERMAL_STREAM_IO
+        end = std::min(end, size);
+        if (end < size && end < released + STREAM_RELEASE_CHUNK) return;
+
+        uint64_t firstPage = released / pageSize;
+        uint64_t endPage = end == size ? resident.size() : end / pageSize;
+
+        // Runs of pages that were not cached before the pass
+        for (uint64_t page = firstPage; page < endPage; ) {
+            if (resident[page] & 1) {
+                page++;
+                continue;
+            }
+
+            uint64_t run = page;
+            while (run < endPage && !(resident[run] & 1)) run++;
+            posix_fadvise(fd, static_cast<off_t>(page * pageSize),
+                          static_cast<off_t>((run - page) * pageSize), POSIX_FADV_DONTNEED);
+            page = run;
+        }
+
+        released = end == size ? size : endPage * pageSize;
+#else
+        (void)end;
+#endif
+    }
+
+public:
+    StreamingRead() = default;
+    StreamingRead(const StreamingRead&) = delete;
+    StreamingRead& operator=(const StreamingRead&) = delete;
+
+    ~StreamingRead() {
+        close();
+    }
+
+    // Start a pass over path; does nothing where pages cannot be released
+    void open(const std::string& path) {
+        close();
+#ifdef THERMAL_STREAM_IO
+        if (cachedScans()) return;
+
+        fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+            close();
+            return;
+        }
+        size = static_cast<uint64_t>(info.st_size);
+        pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+
+        // Pages already cached (e.g. the recording the server has loaded)
+        // stay cached; without a residency map nothing is released
+        void* mapped = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        bool known = mapped != MAP_FAILED;
+        if (known) {
+            resident.resize((size + pageSize - 1) / pageSize);
+            known = mincore(mapped, size, resident.data()) == 0;
+            munmap(mapped, size);
+        }
+        if (!known) {
+            ::close(fd);
+            fd = -1;
+            resident.clear();
+        }
+#else
+        (void)path;
+#endif
+    }
+
+    // The reader has gone through about fraction of the file
+    void advance(double fraction) {
+        if (fd < 0) return;
+
+        uint64_t position = static_cast<uint64_t>(std::max(0.0, std::min(fraction, 1.0)) * size);
+        if (position > STREAM_RELEASE_LAG) {
+            release(position - STREAM_RELEASE_LAG);
+        }
+    }
+
+    // End the pass; everything not cached before it is released
+    void close() {
+#ifdef THERMAL_STREAM_IO
+        if (fd >= 0) {
+            release(size);
+            ::close(fd);
+        }
+#endif
+        fd = -1;
+        size = 0;
+        released = 0;
+        resident.clear();
+    }
+};
+
+// Sequential file writer with double buffering: write() fills one buffer
+// while a writer thread writes the other. Errors are reported by a later
+// write(), flush() or close().
+class StreamWriter {
+private:
+    uint8_t* buffers[2] = { nullptr, nullptr };
+    int current = 0;       // Buffer write() fills
+    size_t filled = 0;
+    uint64_t offset = 0;   // File offset of the current buffer
+    bool opened = false;
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable written;
+    bool pending = false;  // The other buffer is being written
+    size_t pendingBytes = 0;
+    uint64_t pendingOffset = 0;
+    bool stopping = false;
+    bool failed = false;
+
+#ifdef THERMAL_STREAM_IO
+    int fd = -1;
+    bool direct = false;   // O_DIRECT is set on fd
+    bool release = false;  // Written pages are dropped from the cache
+#else
+    std::ofstream file;
+#endif
+
+    static uint8_t* allocateBuffer() {
+#ifdef THERMAL_STREAM_IO
+        void* buffer = nullptr;
+        if (posix_memalign(&buffer, STREAM_ALIGNMENT, STREAM_BUFFER_BYTES) != 0) {
+            throw std::bad_alloc();
+        }
+        return static_cast<uint8_t*>(buffer);
+#else
+        return new uint8_t[STREAM_BUFFER_BYTES];
+#endif
+    }
+
+    static void freeBuffer(uint8_t* buffer) {
+#ifdef THERMAL_STREAM_IO
+        std::free(buffer);
+#else
+        delete[] buffer;
+#endif
+    }
+
+    // Only one thread writes at a time: the writer thread, or the caller
+    // once nothing is pending
+    bool writeRange(const uint8_t* data, size_t bytes, uint64_t at) {
+#ifdef THERMAL_STREAM_IO
+        // O_DIRECT needs whole blocks; an unaligned tail goes through the
+        // cache and is dropped like the buffered fallback
+        if (direct && (bytes % STREAM_ALIGNMENT != 0 || at % STREAM_ALIGNMENT != 0)) {
+            int flags = fcntl(fd, F_GETFL);
+            if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_DIRECT) != 0) return false;
+            direct = false;
+        }
+
+        for (size_t done = 0; done < bytes; ) {
+            ssize_t count = pwrite(fd, data + done, bytes - done, static_cast<off_t>(at + done));
+            if (count < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            done += static_cast<size_t>(count);
+        }
+
+        if (release && !direct) {
+            sync_file_range(fd, static_cast<off_t>(at), static_cast<off_t>(bytes),
+                            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+            posix_fadvise(fd, static_cast<off_t>(at), static_cast<off_t>(bytes), POSIX_FADV_DONTNEED);
+        }
+        return true;
+#else
+        file.seekp(static_cast<std::streamoff>(at));
+        file.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        return file.good();
+#endif
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || pending; });
+            if (!pending) return;
+
+            const uint8_t* data = buffers[1 - current];
+            size_t bytes = pendingBytes;
+            uint64_t at = pendingOffset;
+            lock.unlock();
+
+            bool ok = writeRange(data, bytes, at);
+
+            lock.lock();
+            failed = failed || !ok;
+            pending = false;
+            written.notify_all();
+        }
+    }
+
+    // Hand the filled buffer to the writer thread once the other is written
+    bool submit() {
+        std::unique_lock<std::mutex> lock(mutex);
+        written.wait(lock, [this] { return !pending; });
+        if (failed) return false;
+        if (filled == 0) return true;
+
+        pending = true;
+        pendingBytes = filled;
+        pendingOffset = offset;
+        offset += filled;
+        filled = 0;
+        current = 1 - current;
+        wake.notify_one();
+        return true;
+    }
+
+public:
+    StreamWriter() = default;
+    StreamWriter(const StreamWriter&) = delete;
+    StreamWriter& operator=(const StreamWriter&) = delete;
+
+    ~StreamWriter() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+
+#ifdef THERMAL_STREAM_IO
+        release = !cachedScans();
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | (release ? O_DIRECT : 0), 0644);
+        direct = fd >= 0 && release;
+        if (fd < 0 && release) {
+            fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        }
+        if (fd < 0) return false;
+#else
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+#endif
+
+        buffers[0] = allocateBuffer();
+        buffers[1] = allocateBuffer();
+        current = 0;
+        filled = 0;
+        offset = 0;
+        pending = false;
+        stopping = false;
+        failed = false;
+        writer = std::thread(&StreamWriter::run, this);
+        opened = true;
+        return true;
+    }
+
+    bool isOpen() const { return opened; }
+
+    bool write(const void* data, size_t bytes) {
+        const uint8_t* source = static_cast<const uint8_t*>(data);
+        while (bytes > 0) {
+            size_t count = std::min(bytes, STREAM_BUFFER_BYTES - filled);
+            std::memcpy(buffers[current] + filled, source, count);
+            filled += count;
+            source += count;
+            bytes -= count;
+
+            if (filled == STREAM_BUFFER_BYTES && !submit()) return false;
+        }
+        return true;
+    }
+
+    // Write out everything buffered and wait for it
+    bool flush() {
+        if (!opened || !submit()) return false;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        written.wait(lock, [this] { return !pending; });
+        return !failed;
+    }
+
+    // Overwrite bytes already written (e.g. a header); at most
+    // STREAM_BUFFER_BYTES
+    bool rewrite(uint64_t at, const void* data, size_t bytes) {
+        if (bytes > STREAM_BUFFER_BYTES || !flush()) return false;
+
+        // The idle buffer doubles as an aligned copy for O_DIRECT
+        std::memcpy(buffers[current], data, bytes);
+        if (!writeRange(buffers[current], bytes, at)) {
+            failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool close() {
+        if (!opened) return false;
+
+        bool ok = flush();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        writer.join();
+
+#ifdef THERMAL_STREAM_IO
+        ok = ::close(fd) == 0 && ok;
+        fd = -1;
+#else
+        file.close();
+        ok = !file.fail() && ok;
+#endif
+        freeBuffer(buffers[0]);
+        freeBuffer(buffers[1]);
+        buffers[0] = buffers[1] = nullptr;
+        opened = false;
+        return ok;
+    }
+};
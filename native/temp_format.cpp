@@ -0,0 +1,219 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include "simd.cpp"
+
+// Compact temperature representations for caches, volumes and transport.
+//
+//   F32       4 bytes, exact
+//   F16       IEEE half; 0.5 °C steps at 512..1024 °C, 1 °C at 1024..2048 °C
+//   U16_DECI  unsigned 0.1 °C steps (0..6553.5 °C); 0 is "no temperature"
+//
+// U16_DECI is the format that keeps 0.1 °C over the 600..1500 °C range.
+// Values <= 0 (no palette match) encode as 0 in both 16-bit formats.
+
+enum class TempFormat : int {
+    F32 = 0,
+    F16 = 1,
+    U16_DECI = 2
+};
+
+static const char* TEMP_FORMAT_NAMES[3] = { "f32", "f16", "u16" };
+
+inline bool parseTempFormat(const std::string& name, TempFormat& format) {
+    for (int i = 0; i < 3; i++) {
+        if (name == TEMP_FORMAT_NAMES[i]) {
+            format = static_cast<TempFormat>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline size_t tempFormatBytes(TempFormat format) {
+    return format == TempFormat::F32 ? 4 : 2;
+}
+
+namespace tempcodec {
+
+// Round-to-nearest-even float -> half
+inline uint16_t floatToHalf(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    if (((bits >> 23) & 0xFF) == 0xFF) {
+        return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));  // Inf / NaN
+    }
+    if (exponent >= 31) {
+        return static_cast<uint16_t>(sign | 0x7C00);  // Overflow to infinity
+    }
+    if (exponent <= 0) {
+        if (exponent < -10) return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - exponent);
+        uint32_t half = mantissa >> shift;
+        uint32_t rest = mantissa & ((1u << shift) - 1);
+        uint32_t midpoint = 1u << (shift - 1);
+        if (rest > midpoint || (rest == midpoint && (half & 1))) half++;
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+    uint32_t rest = mantissa & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) half++;  // May carry into the exponent
+    return static_cast<uint16_t>(half);
+}
+
+inline float halfToFloat(uint16_t half) {
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+    uint32_t exponent = (half >> 10) & 0x1F;
+    uint32_t mantissa = half & 0x3FF;
+    uint32_t bits;
+
+    if (exponent == 0) {
+        if (mantissa == 0) {
+            bits = sign;
+        } else {
+            // Subnormal: normalize
+            exponent = 127 - 15 + 1;
+            while (!(mantissa & 0x400)) {
+                mantissa <<= 1;
+                exponent--;
+            }
+            bits = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+        }
+    } else if (exponent == 31) {
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else {
+        bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+    }
+
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline uint16_t floatToDeci(float value) {
+    if (!(value > 0)) return 0;
+    float scaled = value * 10.0f + 0.5f;
+    return scaled >= 65535.0f ? 65535 : static_cast<uint16_t>(scaled);
+}
+
+inline float deciToFloat(uint16_t value) {
+    return value * 0.1f;
+}
+
+#ifdef THERMAL_X86
+// Both vector paths handle 8 values per step and return how many were done
+THERMAL_TARGET_AVX2_F16C inline size_t encodeAvx2(const float* in, size_t count, TempFormat format, uint16_t* out) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 scale = _mm256_set1_ps(10.0f);
+    const __m256 deciMax = _mm256_set1_ps(6553.5f);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m256 v = _mm256_max_ps(_mm256_loadu_ps(in + i), zero);  // Also maps NaN to 0
+
+        if (format == TempFormat::F16) {
+            __m128i half = _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), half);
+        } else {
+            // Round half up like floatToDeci; packus saturates to 0..65535
+            __m256 clamped = _mm256_min_ps(v, deciMax);
+            __m256i deci = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(clamped, scale), _mm256_set1_ps(0.5f)));
+            __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(deci), _mm256_extracti128_si256(deci, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+        }
+    }
+
+    return i;
+}
+
+THERMAL_TARGET_AVX2_F16C inline size_t decodeAvx2(const uint16_t* in, size_t count, TempFormat format, float* out) {
+    const __m256 scale = _mm256_set1_ps(0.1f);
+    size_t i = 0;
+
+    for (; i + 8 <= count; i += 8) {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+
+        if (format == TempFormat::F16) {
+            _mm256_storeu_ps(out + i, _mm256_cvtph_ps(packed));
+        } else {
+            __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(packed));
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(v, scale));
+        }
+    }
+
+    return i;
+}
+#endif
+
+}  // namespace tempcodec
+
+// Encode count temperatures into out (count * tempFormatBytes(format) bytes)
+inline void encodeTemperatures(const float* in, size_t count, TempFormat format, void* out) {
+    if (format == TempFormat::F32) {
+        std::memcpy(out, in, count * sizeof(float));
+        return;
+    }
+
+    uint16_t* packed = static_cast<uint16_t*>(out);
+    size_t i = 0;
+#ifdef THERMAL_X86
+    if (simd::hasF16c()) {
+        i = tempcodec::encodeAvx2(in, count, format, packed);
+    }
+#endif
+    for (; i < count; i++) {
+        float value = in[i] > 0 ? in[i] : 0.0f;
+        packed[i] = format == TempFormat::F16 ? tempcodec::floatToHalf(value) : tempcodec::floatToDeci(value);
+    }
+}
+
+inline void decodeTemperatures(const void* in, size_t count, TempFormat format, float* out) {
+    if (format == TempFormat::F32) {
+        std::memcpy(out, in, count * sizeof(float));
+        return;
+    }
+
+    const uint16_t* packed = static_cast<const uint16_t*>(in);
+    size_t i = 0;
+#ifdef THERMAL_X86
+    if (simd::hasF16c()) {
+        i = tempcodec::decodeAvx2(packed, count, format, out);
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = format == TempFormat::F16 ? tempcodec::halfToFloat(packed[i]) : tempcodec::deciToFloat(packed[i]);
+    }
+}
+
+// Temperatures stored in a compact format, e.g. as a cache entry
+struct TemperatureBuffer {
+    TempFormat format = TempFormat::F32;
+    size_t count = 0;
+    std::vector<uint8_t> data;
+
+    TemperatureBuffer() {}
+
+    TemperatureBuffer(const std::vector<float>& temps, TempFormat fmt)
+        : format(fmt), count(temps.size()), data(temps.size() * tempFormatBytes(fmt)) {
+        encodeTemperatures(temps.data(), count, format, data.data());
+    }
+
+    std::vector<float> decode() const {
+        std::vector<float> temps(count);
+        decodeTemperatures(data.data(), count, format, temps.data());
+        return temps;
+    }
+
+    size_t bytes() const { return data.size() + sizeof(TemperatureBuffer); }
+};
@@ -0,0 +1,326 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include "temp_format.cpp"
+#include "batch_read.cpp"
+#include "stream_io.cpp"
+
+// Temperature volumes: converted temperature planes of a recording, one per
+// exported frame, in a compact TempFormat. Frames start on page boundaries
+// so they can be read with direct I/O.
+//
+//   header (VOLUME_HEADER_BYTES, zero padded)
+//     uint32 magic "TVOL", version, width, height, frameCount,
+//            firstFrame, frameStep, format; double fps
+//   frameCount frames, each width * height samples row-major,
+//   padded to a multiple of VOLUME_ALIGNMENT
+
+static const size_t VOLUME_ALIGNMENT = 4096;
+static const size_t VOLUME_HEADER_BYTES = VOLUME_ALIGNMENT;
+
+// Volume frames read ahead of sequential playback
+static const int VOLUME_READ_AHEAD = 8;
+
+struct TemperatureVolume {
+    static constexpr uint32_t MAGIC = 0x4C4F5654;  // "TVOL"
+    static constexpr uint32_t VERSION = 1;
+
+    int width = 0;
+    int height = 0;
+    int frameCount = 0;
+    int firstFrame = 0;  // Source frame of volume frame 0
+    int frameStep = 1;   // Source frames between volume frames
+    TempFormat format = TempFormat::U16_DECI;
+    double fps = 0;
+
+    size_t frameBytes() const {
+        return static_cast<size_t>(width) * height * tempFormatBytes(format);
+    }
+
+    size_t frameStride() const {
+        return (frameBytes() + VOLUME_ALIGNMENT - 1) / VOLUME_ALIGNMENT * VOLUME_ALIGNMENT;
+    }
+
+    uint64_t frameOffset(int index) const {
+        return VOLUME_HEADER_BYTES + static_cast<uint64_t>(index) * frameStride();
+    }
+
+    // Volume frame holding a source frame, or -1
+    int indexOf(int sourceFrame) const {
+        int offset = sourceFrame - firstFrame;
+        if (offset < 0 || offset % frameStep != 0 || offset / frameStep >= frameCount) return -1;
+        return offset / frameStep;
+    }
+
+    std::vector<char> headerBytes() const {
+        std::vector<char> header(VOLUME_HEADER_BYTES, 0);
+        uint32_t fields[8] = {
+            MAGIC, VERSION,
+            static_cast<uint32_t>(width), static_cast<uint32_t>(height),
+            static_cast<uint32_t>(frameCount), static_cast<uint32_t>(firstFrame),
+            static_cast<uint32_t>(frameStep), static_cast<uint32_t>(format)
+        };
+        std::memcpy(header.data(), fields, sizeof(fields));
+        std::memcpy(header.data() + sizeof(fields), &fps, sizeof(fps));
+        return header;
+    }
+
+    bool readHeader(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open temperature volume: " << path << std::endl;
+            return false;
+        }
+
+        uint32_t fields[8];
+        if (!file.read(reinterpret_cast<char*>(fields), sizeof(fields)) ||
+            !file.read(reinterpret_cast<char*>(&fps), sizeof(fps)) ||
+            fields[0] != MAGIC || fields[1] != VERSION || fields[7] > static_cast<uint32_t>(TempFormat::U16_DECI)) {
+            std::cerr << "Error: Not a temperature volume: " << path << std::endl;
+            return false;
+        }
+
+        width = static_cast<int>(fields[2]);
+        height = static_cast<int>(fields[3]);
+        frameCount = static_cast<int>(fields[4]);
+        firstFrame = static_cast<int>(fields[5]);
+        frameStep = std::max(1, static_cast<int>(fields[6]));
+        format = static_cast<TempFormat>(fields[7]);
+        return true;
+    }
+};
+
+// Streams frames into a volume file; the header is rewritten with the final
+// frame count by finish(). Exports are one-shot, so the file is written past
+// the page cache (see StreamWriter).
+class VolumeWriter {
+private:
+    StreamWriter file;
+    std::vector<uint8_t> encoded;
+
+public:
+    TemperatureVolume volume;
+
+    bool open(const std::string& path, const TemperatureVolume& layout) {
+        volume = layout;
+        volume.frameCount = 0;
+        if (!file.open(path)) {
+            std::cerr << "Error: Could not write temperature volume: " << path << std::endl;
+            return false;
+        }
+
+        std::vector<char> header = volume.headerBytes();
+        encoded.assign(volume.frameStride(), 0);
+        return file.write(header.data(), header.size());
+    }
+
+    // temps holds width * height values
+    bool append(const float* temps) {
+        encodeTemperatures(temps, static_cast<size_t>(volume.width) * volume.height, volume.format, encoded.data());
+        volume.frameCount++;
+        return file.write(encoded.data(), encoded.size());
+    }
+
+    bool finish() {
+        std::vector<char> header = volume.headerBytes();
+        bool ok = file.rewrite(0, header.data(), header.size());
+        return file.close() && ok;
+    }
+};
+
+// Frames of volume as 0.1 °C samples, whatever the stored format, read
+// through reader in one batch; planes of frames that could not be read
+// are left empty. Returns the number read.
+inline size_t readVolumeFrames(BatchReader& reader, const TemperatureVolume& volume,
+                               const std::vector<int>& indices, std::vector<std::vector<uint16_t>>& planes) {
+    planes.assign(indices.size(), std::vector<uint16_t>());
+    if (!reader.isOpen()) {
+        return 0;
+    }
+
+    size_t count = static_cast<size_t>(volume.width) * volume.height;
+    size_t frameBytes = volume.frameBytes();
+    bool deciStored = volume.format == TempFormat::U16_DECI;
+
+    // 0.1 °C frames are read straight into their planes
+    std::vector<uint8_t> raw;
+    if (!deciStored) {
+        raw.resize(frameBytes * indices.size());
+    }
+
+    std::vector<ReadRequest> requests;
+    std::vector<size_t> slots;
+    for (size_t i = 0; i < indices.size(); i++) {
+        if (indices[i] < 0 || indices[i] >= volume.frameCount) continue;
+
+        ReadRequest request;
+        request.offset = volume.frameOffset(indices[i]);
+        request.length = frameBytes;
+        if (deciStored) {
+            planes[i].resize(count);
+            request.buffer = reinterpret_cast<uint8_t*>(planes[i].data());
+        } else {
+            request.buffer = raw.data() + i * frameBytes;
+        }
+        requests.push_back(request);
+        slots.push_back(i);
+    }
+
+    reader.read(requests);
+
+    size_t read = 0;
+    std::vector<float> temps;
+    for (size_t r = 0; r < requests.size(); r++) {
+        std::vector<uint16_t>& deci = planes[slots[r]];
+        if (!requests[r].ok) {
+            std::cerr << "Error: Truncated temperature volume frame " << indices[slots[r]] << std::endl;
+            deci.clear();
+            continue;
+        }
+
+        if (!deciStored) {
+            deci.resize(count);
+            temps.resize(count);
+            decodeTemperatures(requests[r].buffer, count, volume.format, temps.data());
+            encodeTemperatures(temps.data(), count, TempFormat::U16_DECI, deci.data());
+        }
+        read++;
+    }
+    return read;
+}
+
+// Random access to the frames of a volume. The frames of one call are read
+// concurrently (see BatchReader).
+class VolumeReader {
+private:
+    BatchReader reader;
+    std::mutex mutex;
+
+public:
+    TemperatureVolume volume;
+
+    bool open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex);
+        reader.close();
+        if (!volume.readHeader(path)) {
+            return false;
+        }
+
+        return reader.open(path);
+    }
+
+    bool isOpen() const { return reader.isOpen(); }
+    const char* ioBackend() const { return reader.backend(); }
+
+    // Volume frames as 0.1 °C samples (see readVolumeFrames)
+    size_t readFrames(const std::vector<int>& indices, std::vector<std::vector<uint16_t>>& planes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return readVolumeFrames(reader, volume, indices, planes);
+    }
+
+    // Volume frame index as 0.1 °C samples, whatever the stored format
+    bool readFrame(int index, std::vector<uint16_t>& deci) {
+        std::vector<std::vector<uint16_t>> planes;
+        if (readFrames(std::vector<int>{ index }, planes) == 0) {
+            return false;
+        }
+
+        deci.swap(planes[0]);
+        return true;
+    }
+};
+
+// Reads volume frames ahead of playback in batches on a background thread
+// and hands each frame to onFrame (e.g. to encode and cache its tiles). It
+// has its own reader, so interactive reads never wait behind a batch.
+class VolumeReadAhead {
+private:
+    BatchReader reader;
+    TemperatureVolume volume;
+    std::function<void(int, const std::vector<uint16_t>&)> onFrame;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::vector<int> queue;
+    bool stopping = false;
+
+    void run() {
+        while (true) {
+            std::vector<int> indices;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (stopping) break;
+                indices.swap(queue);
+            }
+
+            std::vector<std::vector<uint16_t>> planes;
+            readVolumeFrames(reader, volume, indices, planes);
+            for (size_t i = 0; i < indices.size(); i++) {
+                if (!planes[i].empty()) {
+                    onFrame(indices[i], planes[i]);
+                }
+            }
+        }
+    }
+
+public:
+    ~VolumeReadAhead() {
+        stop();
+    }
+
+    // Read ahead in the volume at path with the given layout
+    bool start(const std::string& path, const TemperatureVolume& layout,
+               std::function<void(int, const std::vector<uint16_t>&)> callback) {
+        stop();
+        if (!reader.open(path)) {
+            return false;
+        }
+
+        volume = layout;
+        onFrame = callback;
+        stopping = false;
+        worker = std::thread(&VolumeReadAhead::run, this);
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            queue.clear();
+        }
+        wake.notify_all();
+        if (worker.joinable()) {
+            worker.join();
+        }
+        reader.close();
+    }
+
+    // Replace pending read-ahead; a batch already being read completes
+    void request(const std::vector<int>& indices) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue = indices;
+        }
+        wake.notify_all();
+    }
+};
+
+// One encoded tile of a volume frame (see profilecodec::encodeTile)
+struct VolumeTile {
+    int x;
+    int y;
+    int width;
+    int height;
+    std::vector<uint8_t> data;
+};
@@ -0,0 +1,103 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+
+// Temperatures of one frame, converted pixel by pixel on demand for one
+// client session. While a line endpoint is dragged, most of the line's
+// pixels were converted for earlier positions; only the pixels it newly
+// covers are looked up, the rest are gathered from the plane. Moving to
+// another recording, frame or colour mapping starts a new epoch, which
+// invalidates every pixel without clearing the plane.
+//
+// Planes live in the cache manager (CacheClass::TEMPERATURE) as const
+// entries; the converted state is updated under the plane's own mutex.
+class TemperaturePlane {
+public:
+    TemperaturePlane(int planeWidth, int planeHeight)
+        : width(planeWidth), height(planeHeight),
+          temps(static_cast<size_t>(planeWidth) * planeHeight),
+          stamps(static_cast<size_t>(planeWidth) * planeHeight, 0) {}
+
+    bool fits(int frameWidth, int frameHeight) const {
+        return width == frameWidth && height == frameHeight;
+    }
+
+    size_t bytes() const {
+        return sizeof(TemperaturePlane) + temps.size() * sizeof(float) + stamps.size() * sizeof(uint16_t);
+    }
+
+    // Temperatures at positions (inside the plane) of frameNumber of the
+    // recording videoKey (see FrameService) as converted with lut. convertPixels(missing, values) converts the
+    // positions not converted yet in this epoch; if it throws, they stay
+    // unconverted.
+    template <typename ConvertPixels>
+    void sample(uint64_t videoKey, int frameNumber, const std::shared_ptr<const void>& lut,
+                const std::vector<std::pair<int, int>>& positions,
+                std::vector<float>& out, ConvertPixels&& convertPixels) const {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // A weak reference cannot mistake a new table at a reused address
+        // for the old one
+        if (videoKey != currentVideo || frameNumber != currentFrame ||
+            currentLut.expired() || currentLut.lock() != lut) {
+            startEpoch();
+            currentVideo = videoKey;
+            currentFrame = frameNumber;
+            currentLut = lut;
+        }
+
+        missing.clear();
+        for (const auto& position : positions) {
+            size_t index = static_cast<size_t>(position.second) * width + position.first;
+            if (stamps[index] != epoch) {
+                stamps[index] = epoch;  // Also dedups repeated positions
+                missing.push_back(position);
+            }
+        }
+
+        if (!missing.empty()) {
+            try {
+                convertPixels(missing, converted);
+            } catch (...) {
+                for (const auto& position : missing) {
+                    stamps[static_cast<size_t>(position.second) * width + position.first] = 0;
+                }
+                throw;
+            }
+            for (size_t i = 0; i < missing.size(); i++) {
+                temps[static_cast<size_t>(missing[i].second) * width + missing[i].first] = converted[i];
+            }
+        }
+
+        out.resize(positions.size());
+        for (size_t i = 0; i < positions.size(); i++) {
+            out[i] = temps[static_cast<size_t>(positions[i].second) * width + positions[i].first];
+        }
+    }
+
+private:
+    int width;
+    int height;
+
+    mutable std::mutex mutex;
+    mutable std::vector<float> temps;
+    mutable std::vector<uint16_t> stamps;  // Epoch in which each pixel was converted
+    mutable uint16_t epoch = 0;
+    mutable uint64_t currentVideo = 0;
+    mutable int currentFrame = -1;
+    mutable std::weak_ptr<const void> currentLut;
+    mutable std::vector<std::pair<int, int>> missing;
+    mutable std::vector<float> converted;
+
+    void startEpoch() const {
+        if (++epoch == 0) {
+            // Wrapped around: stamps from 65536 epochs ago would look current
+            std::fill(stamps.begin(), stamps.end(), 0);
+            epoch = 1;
+        }
+    }
+};
@@ -6,17 +6,100 @@
 #include <sstream>
 #include <iostream>
 #include <cmath>
+#include <array>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include "geometry.cpp"
+#include "envelope.cpp"
+#include "frame_cache.cpp"
+#include "numa_alloc.cpp"
+#include "planar_frame.cpp"
+#include "color_lut.cpp"
+#include "temp_format.cpp"
+#include "temp_volume.cpp"
+#include "profile_codec.cpp"
+#include "temperature_plane.cpp"
+#include "query_plan.cpp"
+#include "pixel_gather.cpp"
+#include "frame_ring.cpp"
 
 class ThermalEngine {
 private:
     cv::VideoCapture cap;
     std::unordered_map<uint32_t, float> tempMapping;
-    cv::Mat currentFrame;
+    std::shared_ptr<ColorLut> colorLut = std::make_shared<ColorLut>();  // Swapped on reload
+    mutable std::mutex colorLutMutex;  // Guards the pointer, not the table
+    Frame currentFrame;
+    std::string videoPath;
+    uint64_t videoKey = 0;     // Identity of the loaded recording (see FrameService)
     int totalFrames;
     double fps;
     int frameWidth;
     int frameHeight;
     int lastFrameNumber = -1;
+    int decoderPosition = -1;  // Frame the next cap.read() returns without seeking
+    
+    // One memory budget for decoded frames, results and other cached data
+    CacheManager cacheManager{static_cast<size_t>(512) * 1024 * 1024};
+    
+    // Decoded frames shared with the low-priority prefetch thread and the
+    // broadcast; each frame of a recording is decoded once at a time
+    FrameCache frameCache{cacheManager};
+    FrameService frameService{frameCache};
+    FramePrefetcher prefetcher{frameService};
+    
+    // Representation of cached temperature data (see temp_format.cpp)
+    std::atomic<int> storageFormat{static_cast<int>(TempFormat::F32)};
+    
+    // Temperature volume of the loaded video for client-side sampling, read
+    // ahead while playback moves forward through it
+    VolumeReader volumeReader;
+    VolumeReadAhead volumeReadAhead;
+    std::atomic<int> lastVolumeFrame{-1};
+    std::atomic<int> readAheadTileSize{0};
+    
+    // Frames published by a running broadcast (see frame_broadcast.cpp)
+    FrameRing broadcastRing;
+    
+    // Prepared query plans by handle (see prepareQuery)
+    std::mutex queryMutex;
+    std::unordered_map<uint32_t, std::shared_ptr<const QueryPlan>> preparedQueries;
+    uint32_t nextQueryHandle = 1;
+
+    static double elapsedMs(int64_t startTicks) {
+        return (cv::getTickCount() - startTicks) * 1000.0 / cv::getTickFrequency();
+    }
+
+    // Session planes share CacheClass::TEMPERATURE with volume tiles, whose
+    // keys never have the top bit set
+    static constexpr uint64_t SESSION_PLANE_KEY = 1ULL << 63;
+
+    // Cache key for a line profile: frame, endpoints and pyramid level
+    static uint64_t lineResultKey(int frameNumber, int x1, int y1, int x2, int y2, int level) {
+        uint64_t key = 1469598103934665603ULL;  // FNV-1a
+        const int fields[6] = { frameNumber, x1, y1, x2, y2, level };
+        for (int field : fields) {
+            key = (key ^ static_cast<uint32_t>(field)) * 1099511628211ULL;
+        }
+        return key;
+    }
+
+    // Cache key for the pixels of a line on the loaded video, for any frame
+    uint64_t lineGeometryKey(int x1, int y1, int x2, int y2, int level) const {
+        uint64_t key = 1469598103934665603ULL;  // FNV-1a
+        const int fields[7] = { x1, y1, x2, y2, level, frameWidth, frameHeight };
+        for (int field : fields) {
+            key = (key ^ static_cast<uint32_t>(field)) * 1099511628211ULL;
+        }
+        return key;
+    }
+
+    // Cache key for the pixel offsets of a geometry (see getPixelOffsets)
+    static uint64_t offsetsKey(uint64_t geometryKey) {
+        return (geometryKey ^ 0x4F46465345545321ULL) * 1099511628211ULL;
+    }
 
     // Pack RGB values into a single uint32_t for hash map key
     uint32_t packRGB(int r, int g, int b) {
@@ -25,44 +108,191 @@ private:
                static_cast<uint32_t>(b);
     }
 
-    // Bresenham's line algorithm for pixel interpolation
-    std::vector<std::pair<int, int>> getLinePixels(int x1, int y1, int x2, int y2) {
+    // Full resolution pixels of a line rasterized on pyramid level level
+    std::vector<std::pair<int, int>> getLevelLinePixels(int x1, int y1, int x2, int y2, int width, int height, int level) {
+        return getLinePixels(x1 >> level, y1 >> level, x2 >> level, y2 >> level,
+                             (width + (1 << level) - 1) >> level, (height + (1 << level) - 1) >> level, level);
+    }
+
+    // Bresenham's line algorithm for pixel interpolation. The line is clipped
+    // to the frame once (clipLine) and only its visible span is walked. With
+    // level > 0 the coordinates are on that pyramid level and the pixels are
+    // returned scaled back to full resolution.
+    std::vector<std::pair<int, int>> getLinePixels(int x1, int y1, int x2, int y2, int width, int height, int level = 0) {
         std::vector<std::pair<int, int>> pixels;
         
-        int dx = abs(x2 - x1);
-        int dy = abs(y2 - y1);
-        int sx = (x1 < x2) ? 1 : -1;
-        int sy = (y1 < y2) ? 1 : -1;
-        int err = dx - dy;
+        LineSpan span;
+        if (!clipLine(x1, y1, x2, y2, width, height, span)) {
+            return pixels;
+        }
         
-        int x = x1, y = y1;
+        pixels.reserve(span.count);
+        walkLineSpan(span, [&](int x, int y) {
+            pixels.push_back({x << level, y << level});
+        });
         
-        while (true) {
-            // Ensure pixel is within frame bounds
-            if (x >= 0 && x < frameWidth && y >= 0 && y < frameHeight) {
-                pixels.push_back({x, y});
+        return pixels;
+    }
+
+    std::shared_ptr<ColorLut> getColorLut() const {
+        std::lock_guard<std::mutex> lock(colorLutMutex);
+        return colorLut;
+    }
+
+    // Convert pixels at (x, y) positions through the colour lookup table.
+    // Planar frames are gathered plane by plane; interleaved ones are
+    // de-interleaved into the same channel arrays first.
+    void convertPixels(const Frame& frame, const std::vector<std::pair<int, int>>& positions,
+                       std::vector<float>& temps) {
+        size_t count = positions.size();
+        std::vector<uint8_t> channels(count * 3);
+        uint8_t* r = channels.data();
+        uint8_t* g = r + count;
+        uint8_t* b = g + count;
+        
+        if (frame.isPlanar()) {
+            const PlanarFrame& planar = frame.planar;
+            const uint8_t* rPlane = planar.plane(0);
+            const uint8_t* gPlane = planar.plane(1);
+            const uint8_t* bPlane = planar.plane(2);
+            for (size_t i = 0; i < count; i++) {
+                size_t offset = static_cast<size_t>(positions[i].second) * planar.stride + positions[i].first;
+                r[i] = rPlane[offset];
+                g[i] = gPlane[offset];
+                b[i] = bPlane[offset];
             }
-            
-            if (x == x2 && y == y2) break;
-            
-            int e2 = 2 * err;
-            if (e2 > -dy) {
-                err -= dy;
-                x += sx;
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                // OpenCV uses BGR, not RGB
+                const cv::Vec3b& bgr = frame.bgr.at<cv::Vec3b>(positions[i].second, positions[i].first);
+                r[i] = bgr[2];
+                g[i] = bgr[1];
+                b[i] = bgr[0];
+            }
+        }
+        
+        temps.resize(count);
+        getColorLut()->convert(r, g, b, count, temps.data());
+    }
+
+    // Convert the pixels at precomputed frame offsets (see PixelOffsets)
+    void convertOffsets(const Frame& frame, const PixelOffsets& offsets, std::vector<float>& temps) {
+        size_t count = offsets.offsets.size();
+        std::vector<uint8_t> channels(count * 3);
+        uint8_t* r = channels.data();
+        uint8_t* g = r + count;
+        uint8_t* b = g + count;
+        
+        offsets.gather(frame, r, g, b);
+        
+        temps.resize(count);
+        getColorLut()->convert(r, g, b, count, temps.data());
+    }
+
+    // Pixel offsets of a geometry in frame's layout, cached next to the
+    // geometry (CacheClass::GEOMETRY) and reused for every frame of the
+    // video; pixels() is only called to build them
+    template <typename Pixels>
+    std::shared_ptr<const PixelOffsets> getPixelOffsets(uint64_t geometryKey, const Frame& frame, Pixels&& pixels) {
+        uint64_t key = offsetsKey(geometryKey);
+        auto offsets = cacheManager.get<PixelOffsets>(CacheClass::GEOMETRY, key);
+        if (!offsets || !offsets->matches(frame)) {
+            int64_t startTicks = cv::getTickCount();
+            auto built = std::make_shared<const PixelOffsets>(PixelOffsets::build(frame, pixels()));
+            cacheManager.put(CacheClass::GEOMETRY, key, built, built->bytes(), elapsedMs(startTicks));
+            offsets = built;
+        }
+        return offsets;
+    }
+
+    static uint64_t volumeTileKey(int frameNumber, int tileSize) {
+        return (static_cast<uint64_t>(frameNumber) << 32) | static_cast<uint32_t>(tileSize);
+    }
+
+    // Encode a 0.1 °C volume plane into tiles and cache them; readMs is
+    // what reading the plane cost
+    std::shared_ptr<const std::vector<VolumeTile>> cacheVolumeTiles(int frameNumber, int tileSize,
+                                                                    const std::vector<uint16_t>& plane, double readMs) {
+        int64_t startTicks = cv::getTickCount();
+        const TemperatureVolume& volume = volumeReader.volume;
+        auto tiles = std::make_shared<std::vector<VolumeTile>>();
+        size_t bytes = sizeof(std::vector<VolumeTile>);
+        
+        for (int y = 0; y < volume.height; y += tileSize) {
+            for (int x = 0; x < volume.width; x += tileSize) {
+                int w = std::min(tileSize, volume.width - x);
+                int h = std::min(tileSize, volume.height - y);
+                tiles->push_back({ x, y, w, h, profilecodec::encodeTile(plane.data(), volume.width, x, y, w, h) });
+                bytes += sizeof(VolumeTile) + tiles->back().data.size();
             }
-            if (e2 < dx) {
-                err += dx;
-                y += sy;
+        }
+        
+        std::shared_ptr<const std::vector<VolumeTile>> result = tiles;
+        cacheManager.put(CacheClass::TEMPERATURE, volumeTileKey(frameNumber, tileSize), result, bytes,
+                         readMs + elapsedMs(startTicks));
+        return result;
+    }
+
+    // Sequential playback through the volume: queue the next frames that
+    // are not cached yet
+    void readAheadVolume(int frameNumber, int tileSize) {
+        const TemperatureVolume& volume = volumeReader.volume;
+        int previous = lastVolumeFrame.exchange(frameNumber);
+        if (previous < 0 || frameNumber <= previous || frameNumber - previous > 4 * volume.frameStep) return;
+        
+        readAheadTileSize = tileSize;
+        std::vector<int> wanted;
+        int index = volume.indexOf(frameNumber);
+        for (int next = index + 1; next <= index + VOLUME_READ_AHEAD && next < volume.frameCount; next++) {
+            int nextFrame = volume.firstFrame + next * volume.frameStep;
+            if (!cacheManager.contains(CacheClass::TEMPERATURE, volumeTileKey(nextFrame, tileSize))) {
+                wanted.push_back(next);
             }
         }
         
-        return pixels;
+        if (!wanted.empty()) {
+            volumeReadAhead.request(wanted);
+        }
+    }
+
+    // Convert the rectangle [x0, x1) x [y0, y1) row by row into out
+    void convertRegion(const Frame& frame, int x0, int y0, int x1, int y1, float* out) {
+        size_t rowLength = static_cast<size_t>(x1 - x0);
+        std::shared_ptr<ColorLut> lut = getColorLut();
+        
+        if (frame.isPlanar()) {
+            // Rows of each plane are contiguous: convert them in place
+            const PlanarFrame& planar = frame.planar;
+            for (int y = y0; y < y1; y++) {
+                size_t offset = static_cast<size_t>(y) * planar.stride + x0;
+                lut->convert(planar.plane(0) + offset, planar.plane(1) + offset, planar.plane(2) + offset,
+                             rowLength, out + (y - y0) * rowLength);
+            }
+            return;
+        }
+        
+        std::vector<uint8_t> channels(rowLength * 3);
+        uint8_t* r = channels.data();
+        uint8_t* g = r + rowLength;
+        uint8_t* b = g + rowLength;
+        
+        for (int y = y0; y < y1; y++) {
+            const cv::Vec3b* row = frame.bgr.ptr<cv::Vec3b>(y) + x0;
+            for (size_t x = 0; x < rowLength; x++) {
+                r[x] = row[x][2];
+                g[x] = row[x][1];
+                b[x] = row[x][0];
+            }
+            lut->convert(r, g, b, rowLength, out + (y - y0) * rowLength);
+        }
     }
 
 public:
     ThermalEngine() : totalFrames(0), fps(0), frameWidth(0), frameHeight(0) {}
     
     ~ThermalEngine() {
+        prefetcher.stop();
+        volumeReadAhead.stop();
         if (cap.isOpened()) {
             cap.release();
         }
@@ -77,6 +307,16 @@ public:
                 return false;
             }
             
+            // Cached frames are keyed by recording: reloading a video reuses
+            // the frames that are still cached
+            videoPath = path;
+            videoKey = FrameService::videoKey(path);
+            lastFrameNumber = -1;
+            decoderPosition = 0;
+            cacheManager.clear(CacheClass::RESULT);
+            broadcastRing.reset();  // The broadcast is stopped before loading
+            prefetcher.start(path, videoKey);
+            
             totalFrames = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_COUNT));
             fps = cap.get(cv::CAP_PROP_FPS);
             frameWidth = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH));
@@ -107,6 +347,7 @@ public:
             std::getline(file, line); // Skip header line
             
             int count = 0;
+            cacheManager.clear(CacheClass::RESULT);
             while (std::getline(file, line)) {
                 std::stringstream ss(line);
                 std::string cell;
@@ -139,6 +380,16 @@ public:
             
             file.close();
             
+            // Threads still converting keep the previous table until they finish
+            std::shared_ptr<ColorLut> lut = std::make_shared<ColorLut>();
+            if (!lut->build(tempMapping)) {
+                return false;
+            }
+            {
+                std::lock_guard<std::mutex> lock(colorLutMutex);
+                colorLut.swap(lut);  // The old table is freed outside the lock
+            }
+            
             std::cout << "Temperature mapping loaded: " << count << " entries" << std::endl;
             return count > 0;
             
@@ -148,25 +399,49 @@ public:
         }
     }
 
-    cv::Mat getFrame(int frameNumber) {
+    // Decoded frame in the cached layout (see setFrameLayout)
+    Frame getAnalysisFrame(int frameNumber) {
         try {
             if (!cap.isOpened()) {
                 std::cerr << "Error: Video not loaded" << std::endl;
-                return cv::Mat();
+                return Frame();
             }
             
             // Clamp frame number to valid range
             frameNumber = std::max(0, std::min(frameNumber, totalFrames - 1));
             
-            // Only seek if we need a different frame
+            // Only decode if we need a different frame
             if (frameNumber != lastFrameNumber) {
-                cap.set(cv::CAP_PROP_POS_FRAMES, frameNumber);
+                Frame frame;
+                
+                // A running broadcast may still hold a frame the cache evicted
+                FrameRing::Entry broadcast;
+                if (broadcastRing.find(frameNumber, broadcast)) {
+                    frame = broadcast.frame;
+                } else {
+                    // The service hands in a fresh Mat: cached frames must never be overwritten
+                    frame = frameService.get(videoKey, frameNumber, [&](cv::Mat& decoded) {
+                        // Sequential playback continues reading without a seek
+                        if (frameNumber != decoderPosition) {
+                            cap.set(cv::CAP_PROP_POS_FRAMES, frameNumber);
+                        }
+                        
+                        if (!cap.read(decoded)) {
+                            decoderPosition = -1;
+                            return false;
+                        }
+                        
+                        decoderPosition = frameNumber + 1;
+                        return true;
+                    });
+                }
                 
-                if (!cap.read(currentFrame)) {
+                if (frame.empty()) {
                     std::cerr << "Error: Could not read frame " << frameNumber << std::endl;
-                    return cv::Mat();
+                    return Frame();
                 }
                 
+                currentFrame = frame;
                 lastFrameNumber = frameNumber;
             }
             
@@ -174,91 +449,879 @@ public:
             
         } catch (const std::exception& e) {
             std::cerr << "Exception getting frame: " << e.what() << std::endl;
-            return cv::Mat();
+            return Frame();
         }
     }
 
+    // Decoded frame as interleaved BGR; planar frames are converted
+    cv::Mat getFrame(int frameNumber) {
+        return getAnalysisFrame(frameNumber).toBgr();
+    }
+
+    // Wrap a frame decoded outside the engine (batch jobs, live capture) for
+    // analysis; reuses the buffers of frame. These frames are only analysed,
+    // never displayed, so they are always planar.
+    void wrapFrame(const cv::Mat& decoded, Frame& frame) const {
+        frame.assign(decoded, FrameLayout::PLANAR);
+    }
+
+    // Layout of the frames the engine caches and displays; already cached
+    // frames are dropped
+    void setFrameLayout(FrameLayout layout) {
+        frameCache.setLayout(layout);
+        frameCache.clear();
+        currentFrame = Frame();
+        lastFrameNumber = -1;
+    }
+
+    FrameLayout getFrameLayout() const { return frameCache.getLayout(); }
+
     float getPixelTemperature(int r, int g, int b) {
-        uint32_t key = packRGB(r, g, b);
-        auto it = tempMapping.find(key);
+        return getColorLut()->lookup(r, g, b);
+    }
+
+    // Sample temperatures along a line in an already decoded frame.
+    // level > 0 rasterizes the line on a virtual pyramid level (nearest-neighbour
+    // 2^level downscale, which keeps palette colours exact), halving the sample
+    // count per level without building the downscaled image.
+    std::vector<float> sampleLine(const Frame& frame, int x1, int y1, int x2, int y2, int level = 0) {
+        std::vector<float> temperatures;
+        
+        // Get pixels along the line
+        std::vector<std::pair<int, int>> linePixels = getLevelLinePixels(x1, y1, x2, y2, frame.width(), frame.height(), level);
+        
+        convertPixels(frame, linePixels, temperatures);
         
-        if (it != tempMapping.end()) {
-            return it->second;
+        // Colours without a temperature are reported as 0
+        for (float& temp : temperatures) {
+            if (temp < 0) temp = 0.0f;
         }
         
-        // If exact match not found, find closest RGB match
-        float minDistance = std::numeric_limits<float>::max();
-        float closestTemp = -1.0f;
+        return temperatures;
+    }
+
+    // Statistics over the valid (> 0) samples, matching the server's calculateStats
+    static RegionStats computeStats(const std::vector<float>& temps) {
+        RegionStats stats;
+        double sum = 0;
         
-        for (const auto& pair : tempMapping) {
-            uint32_t mapKey = pair.first;
-            int mapR = (mapKey >> 16) & 0xFF;
-            int mapG = (mapKey >> 8) & 0xFF;
-            int mapB = mapKey & 0xFF;
+        for (float t : temps) {
+            if (t <= 0) continue;
+            if (stats.count == 0 || t < stats.min) stats.min = t;
+            if (stats.count == 0 || t > stats.max) stats.max = t;
+            sum += t;
+            stats.count++;
+        }
+        
+        if (stats.count > 0) {
+            stats.avg = static_cast<float>(sum / stats.count);
+        }
+        
+        return stats;
+    }
+
+    // Reduce a profile to at most bucketCount buckets of consecutive samples,
+    // with statistics per bucket and over the whole profile in one pass
+    static ProfileBuckets bucketProfile(const std::vector<float>& temps, int bucketCount) {
+        ProfileBuckets result;
+        result.length = temps.size();
+        size_t count = std::min(temps.size(), static_cast<size_t>(std::max(1, bucketCount)));
+        result.buckets.resize(count);
+        
+        double total = 0;
+        for (size_t b = 0; b < count; b++) {
+            RegionStats& bucket = result.buckets[b];
+            size_t start = b * temps.size() / count;
+            size_t end = (b + 1) * temps.size() / count;
+            double sum = 0;
+            
+            for (size_t i = start; i < end; i++) {
+                float t = temps[i];
+                if (t <= 0) continue;
+                if (bucket.count == 0 || t < bucket.min) bucket.min = t;
+                if (bucket.count == 0 || t > bucket.max) bucket.max = t;
+                sum += t;
+                bucket.count++;
+            }
+            
+            if (bucket.count == 0) continue;
+            bucket.avg = static_cast<float>(sum / bucket.count);
             
-            // Calculate Euclidean distance in RGB space
-            float distance = std::sqrt(
-                std::pow(r - mapR, 2) + 
-                std::pow(g - mapG, 2) + 
-                std::pow(b - mapB, 2)
-            );
+            RegionStats& stats = result.total;
+            if (stats.count == 0 || bucket.min < stats.min) stats.min = bucket.min;
+            if (stats.count == 0 || bucket.max > stats.max) stats.max = bucket.max;
+            stats.count += bucket.count;
+            total += sum;
+        }
+        
+        if (result.total.count > 0) {
+            result.total.avg = static_cast<float>(total / result.total.count);
+        }
+        
+        return result;
+    }
+
+    // Temperature statistics over a rectangular region of an already decoded frame
+    RegionStats measureRegion(const Frame& frame, const RegionSpec& region) {
+        int x0 = std::max(0, region.x);
+        int y0 = std::max(0, region.y);
+        int x1 = std::min(frame.width(), region.x + region.width);
+        int y1 = std::min(frame.height(), region.y + region.height);
+        
+        std::vector<float> temps;
+        if (x1 <= x0 || y1 <= y0) {
+            return RegionStats();
+        }
+        
+        temps.resize(static_cast<size_t>(x1 - x0) * (y1 - y0));
+        convertRegion(frame, x0, y0, x1, y1, temps.data());
+        return computeStats(temps);
+    }
+
+    // Temperatures of every pixel, row-major; -1 where no colour matches
+    void temperaturePlane(const Frame& frame, std::vector<float>& plane) {
+        plane.resize(static_cast<size_t>(frame.width()) * frame.height());
+        convertRegion(frame, 0, 0, frame.width(), frame.height(), plane.data());
+    }
+
+    // Min/max/avg of each line; valid[i] is false when line i has no valid samples.
+    // Returns true if at least one line could be measured.
+    bool measureLines(const Frame& frame, const std::vector<LineSegment>& lines,
+                      std::vector<std::array<float, MEASURE_COUNT>>& measurements,
+                      std::vector<bool>& valid) {
+        measurements.resize(lines.size());
+        valid.assign(lines.size(), false);
+        bool any = false;
+        
+        for (size_t i = 0; i < lines.size(); i++) {
+            const LineSegment& line = lines[i];
+            RegionStats stats = computeStats(sampleLine(frame, line.x1, line.y1, line.x2, line.y2));
+            
+            if (stats.count == 0) continue;
+            
+            measurements[i][MEASURE_MIN] = stats.min;
+            measurements[i][MEASURE_MAX] = stats.max;
+            measurements[i][MEASURE_AVG] = stats.avg;
+            valid[i] = true;
+            any = true;
+        }
+        
+        return any;
+    }
+
+    std::vector<float> analyzeLine(int frameNumber, int x1, int y1, int x2, int y2, int level = 0) {
+        return analyzeLines(frameNumber, { LineSegment{ x1, y1, x2, y2 } }, level)[0];
+    }
+
+    // Profiles of several lines of one frame. The frame is fetched once, and
+    // only if some line misses the result cache.
+    // With a session, lines are sampled through the session's temperature
+    // plane, so pixels converted for its earlier requests on the same frame
+    // are not looked up again (see TemperaturePlane).
+    std::vector<std::vector<float>> analyzeLines(int frameNumber, const std::vector<LineSegment>& lines, int level = 0,
+                                                 uint32_t session = 0) {
+        std::vector<std::vector<float>> results(lines.size());
+        Frame frame;
+        auto ensureFrame = [&]() {
+            if (frame.empty()) {
+                frame = getAnalysisFrame(frameNumber);
+            }
+            return !frame.empty();
+        };
+        
+        try {
+            std::shared_ptr<const TemperaturePlane> plane = session ? getSessionPlane(session) : nullptr;
             
-            if (distance < minDistance) {
-                minDistance = distance;
-                closestTemp = pair.second;
+            for (size_t i = 0; i < lines.size(); i++) {
+                const LineSegment& line = lines[i];
                 
-                // If very close, use it immediately
-                if (distance < 10.0f) {
-                    break;
+                // Repeated requests (pause refinement, looping playback) reuse results
+                uint64_t key = lineResultKey(frameNumber, line.x1, line.y1, line.x2, line.y2, level);
+                auto cached = cacheManager.get<TemperatureBuffer>(CacheClass::RESULT, key);
+                if (cached) {
+                    results[i] = cached->decode();
+                    continue;
                 }
+                
+                int64_t startTicks = cv::getTickCount();
+                std::vector<float>& temperatures = results[i];
+                
+                if (plane) {
+                    // Only pixels this session has not converted on this frame are looked up
+                    std::vector<std::pair<int, int>> pixels =
+                        getLevelLinePixels(line.x1, line.y1, line.x2, line.y2, frameWidth, frameHeight, level);
+                    plane->sample(videoKey, frameNumber, getColorLut(), pixels, temperatures,
+                        [&](const std::vector<std::pair<int, int>>& missing, std::vector<float>& values) {
+                            if (!ensureFrame()) {
+                                throw std::runtime_error("Could not get frame for analysis");
+                            }
+                            convertPixels(frame, missing, values);
+                            for (float& temp : values) {
+                                if (temp < 0) temp = 0.0f;
+                            }
+                        });
+                } else {
+                    if (!ensureFrame()) {
+                        std::cerr << "Error: Could not get frame for analysis" << std::endl;
+                        return results;
+                    }
+                    
+                    // The line's offsets are reused while it stays put (playback)
+                    auto offsets = getPixelOffsets(lineGeometryKey(line.x1, line.y1, line.x2, line.y2, level), frame,
+                        [&]() {
+                            return getLevelLinePixels(line.x1, line.y1, line.x2, line.y2,
+                                                      frame.width(), frame.height(), level);
+                        });
+                    convertOffsets(frame, *offsets, temperatures);
+                    
+                    // Colours without a temperature are reported as 0
+                    for (float& temp : temperatures) {
+                        if (temp < 0) temp = 0.0f;
+                    }
+                }
+                
+                // Return what a later cache hit returns, also for 16-bit formats
+                auto stored = std::make_shared<const TemperatureBuffer>(temperatures, getTemperatureFormat());
+                if (stored->format != TempFormat::F32) {
+                    temperatures = stored->decode();
+                }
+                cacheManager.put(CacheClass::RESULT, key, stored, stored->bytes(), elapsedMs(startTicks));
             }
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Exception analyzing line: " << e.what() << std::endl;
         }
         
-        return closestTemp;
+        return results;
+    }
+
+    // Temperature plane of a client session, created on first use
+    std::shared_ptr<const TemperaturePlane> getSessionPlane(uint32_t session) {
+        uint64_t key = SESSION_PLANE_KEY | session;
+        auto plane = cacheManager.get<TemperaturePlane>(CacheClass::TEMPERATURE, key);
+        if (!plane || !plane->fits(frameWidth, frameHeight)) {
+            int64_t startTicks = cv::getTickCount();
+            auto created = std::make_shared<const TemperaturePlane>(frameWidth, frameHeight);
+            cacheManager.put(CacheClass::TEMPERATURE, key, created, created->bytes(), elapsedMs(startTicks));
+            plane = created;
+        }
+        return plane;
     }
 
-    std::vector<float> analyzeLine(int frameNumber, int x1, int y1, int x2, int y2) {
+    void releaseSession(uint32_t session) {
+        cacheManager.erase(CacheClass::TEMPERATURE, SESSION_PLANE_KEY | session);
+    }
+
+    // Profile along a polyline or smooth path (see rasterizePath). The pixels
+    // of a path depend only on its geometry, so they are cached by geometry
+    // hash (CacheClass::GEOMETRY) and reused for every frame; profiles are
+    // cached per frame like line results.
+    std::vector<float> analyzePath(int frameNumber, const PathSpec& path, int level = 0) {
         std::vector<float> temperatures;
         
         try {
-            cv::Mat frame = getFrame(frameNumber);
+            uint64_t geometryKey = pathHash(path, frameWidth, frameHeight, level);
+            uint64_t key = (geometryKey ^ static_cast<uint32_t>(frameNumber)) * 1099511628211ULL;
+            
+            auto cached = cacheManager.get<TemperatureBuffer>(CacheClass::RESULT, key);
+            if (cached) {
+                return cached->decode();
+            }
+            
+            int64_t startTicks = cv::getTickCount();
+            
+            auto pixels = cacheManager.get<std::vector<std::pair<int, int>>>(CacheClass::GEOMETRY, geometryKey);
+            if (!pixels) {
+                int64_t rasterTicks = cv::getTickCount();
+                auto rasterized = std::make_shared<const std::vector<std::pair<int, int>>>(
+                    rasterizePath(path, frameWidth, frameHeight, level));
+                if (rasterized->size() >= MAX_PATH_SAMPLES) {
+                    std::cerr << "Warning: Path profile cut off at " << MAX_PATH_SAMPLES << " samples" << std::endl;
+                }
+                cacheManager.put(CacheClass::GEOMETRY, geometryKey, rasterized,
+                                 rasterized->size() * sizeof(std::pair<int, int>) + sizeof(*rasterized),
+                                 elapsedMs(rasterTicks));
+                pixels = rasterized;
+            }
+            
+            Frame frame = getAnalysisFrame(frameNumber);
             if (frame.empty()) {
                 std::cerr << "Error: Could not get frame for analysis" << std::endl;
                 return temperatures;
             }
             
-            // Get pixels along the line
-            std::vector<std::pair<int, int>> linePixels = getLinePixels(x1, y1, x2, y2);
+            auto offsets = getPixelOffsets(geometryKey, frame,
+                [&]() -> const std::vector<std::pair<int, int>>& { return *pixels; });
+            convertOffsets(frame, *offsets, temperatures);
+            
+            // Colours without a temperature are reported as 0
+            for (float& temp : temperatures) {
+                if (temp < 0) temp = 0.0f;
+            }
+            
+            auto stored = std::make_shared<const TemperatureBuffer>(temperatures, getTemperatureFormat());
+            if (stored->format != TempFormat::F32) {
+                temperatures = stored->decode();
+            }
+            cacheManager.put(CacheClass::RESULT, key, stored, stored->bytes(), elapsedMs(startTicks));
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Exception analyzing path: " << e.what() << std::endl;
+        }
+        
+        return temperatures;
+    }
+
+    // Radial and sector profiles around a centre point. The ring table of a
+    // probe depends only on its geometry and is cached (CacheClass::GEOMETRY);
+    // each query converts the probe's bounding box in one region pass and
+    // bins it through the table.
+    std::shared_ptr<const RadialProfile> analyzeRadial(int frameNumber, const RadialSpec& spec) {
+        try {
+            uint64_t geometryKey = radialHash(spec, frameWidth, frameHeight);
+            uint64_t key = (geometryKey ^ static_cast<uint32_t>(frameNumber)) * 1099511628211ULL;
+            
+            auto cached = cacheManager.get<RadialProfile>(CacheClass::RESULT, key);
+            if (cached) {
+                return cached;
+            }
+            
+            int64_t startTicks = cv::getTickCount();
+            
+            auto table = cacheManager.get<RingTable>(CacheClass::GEOMETRY, geometryKey);
+            if (!table) {
+                int64_t tableTicks = cv::getTickCount();
+                auto built = std::make_shared<const RingTable>(buildRingTable(spec, frameWidth, frameHeight));
+                cacheManager.put(CacheClass::GEOMETRY, geometryKey, built, built->bytes(), elapsedMs(tableTicks));
+                table = built;
+            }
+            
+            std::vector<float> temps(table->bins.size());
+            if (!temps.empty()) {
+                Frame frame = getAnalysisFrame(frameNumber);
+                if (frame.empty()) {
+                    std::cerr << "Error: Could not get frame for analysis" << std::endl;
+                    return nullptr;
+                }
+                convertRegion(frame, table->x0, table->y0, table->x1, table->y1, temps.data());
+            }
+            
+            auto profile = std::make_shared<const RadialProfile>(accumulateRings(*table, temps.data()));
+            cacheManager.put(CacheClass::RESULT, key, profile, profile->bytes(), elapsedMs(startTicks));
+            return profile;
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Exception analyzing radial profile: " << e.what() << std::endl;
+            return nullptr;
+        }
+    }
+
+    // Compiled plan of a query; identical queries share one plan through
+    // the cache (CacheClass::GEOMETRY). Returns null with error set if the
+    // query does not compile.
+    std::shared_ptr<const QueryPlan> compileQuery(const QuerySpec& spec, std::string& error) {
+        uint64_t key = queryHash(spec, frameWidth, frameHeight);
+        auto plan = cacheManager.get<QueryPlan>(CacheClass::GEOMETRY, key);
+        if (plan) {
+            return plan;
+        }
+        
+        int64_t startTicks = cv::getTickCount();
+        auto compiled = std::make_shared<QueryPlan>();
+        error = compiled->compile(spec, frameWidth, frameHeight);
+        if (!error.empty()) {
+            return nullptr;
+        }
+        compiled->key = key;
+        
+        cacheManager.put(CacheClass::GEOMETRY, key, std::shared_ptr<const QueryPlan>(compiled),
+                         compiled->bytes(), elapsedMs(startTicks));
+        return compiled;
+    }
+
+    // Compile a query and keep its plan under a handle until releaseQuery,
+    // so it is run on each new frame without parsing or rasterizing again.
+    // Returns 0 with error set on failure.
+    uint32_t prepareQuery(const QuerySpec& spec, std::string& error) {
+        std::shared_ptr<const QueryPlan> plan = compileQuery(spec, error);
+        if (!plan) {
+            return 0;
+        }
+        
+        std::lock_guard<std::mutex> lock(queryMutex);
+        if (preparedQueries.size() >= MAX_PREPARED_QUERIES) {
+            error = "Too many prepared queries";
+            return 0;
+        }
+        
+        uint32_t handle = nextQueryHandle++;
+        if (nextQueryHandle == 0) nextQueryHandle = 1;
+        preparedQueries[handle] = plan;
+        return handle;
+    }
+
+    std::shared_ptr<const QueryPlan> getPreparedQuery(uint32_t handle) {
+        std::lock_guard<std::mutex> lock(queryMutex);
+        auto it = preparedQueries.find(handle);
+        return it != preparedQueries.end() ? it->second : nullptr;
+    }
+
+    void releaseQuery(uint32_t handle) {
+        std::lock_guard<std::mutex> lock(queryMutex);
+        preparedQueries.erase(handle);
+    }
+
+    // Run a compiled query on frames (see QueryPlan). Frames are fetched in
+    // ascending order, each once; the union of the plan's pixels is converted
+    // once per frame and every output reduces its geometry from it.
+    QueryResult runQuery(const QueryPlan& plan, const std::vector<int>& frames) {
+        QueryResult result = plan.emptyResult(frames.size());
+        
+        try {
+            if (!plan.fits(frameWidth, frameHeight)) {
+                std::cerr << "Error: Query was compiled for another video" << std::endl;
+                return result;
+            }
+            
+            // Ascending frames let sequential ones continue without a seek
+            std::vector<size_t> order(frames.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return frames[a] < frames[b]; });
+            
+            std::vector<float> temps;
+            std::vector<float> gathered;
+            int convertedFrame = -1;
+            
+            for (size_t frameIndex : order) {
+                int frameNumber = frames[frameIndex];
+                
+                // Repeated frames reuse the conversion of the previous one
+                if (frameNumber != convertedFrame) {
+                    convertedFrame = -1;
+                    Frame frame = getAnalysisFrame(frameNumber);
+                    if (frame.empty()) {
+                        std::cerr << "Error: Could not get frame " << frameNumber << " for query" << std::endl;
+                        continue;
+                    }
+                    
+                    convertQueryFrame(plan, frame, temps);
+                    convertedFrame = frameNumber;
+                }
+                
+                plan.reduce(temps, frameIndex, result.outputs, gathered);
+                result.valid[frameIndex] = 1;
+            }
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Exception running query: " << e.what() << std::endl;
+        }
+        
+        return result;
+    }
+
+    // Temperatures of the union of plan's pixels on frame, ready for
+    // plan.reduce; safe to call from any thread
+    void convertQueryFrame(const QueryPlan& plan, const Frame& frame, std::vector<float>& temps) {
+        auto offsets = getPixelOffsets(plan.key, frame,
+            [&]() -> const std::vector<std::pair<int, int>>& { return plan.pixels; });
+        convertOffsets(frame, *offsets, temps);
+        
+        // Colours without a temperature are reported as 0
+        for (float& temp : temps) {
+            if (temp < 0) temp = 0.0f;
+        }
+    }
+
+    // Line profile reduced to bucketCount buckets for display; the full
+    // resolution profile stays cached for analyzeLine
+    ProfileBuckets analyzeLineBuckets(int frameNumber, int x1, int y1, int x2, int y2, int level, int bucketCount) {
+        return bucketProfile(analyzeLine(frameNumber, x1, y1, x2, y2, level), bucketCount);
+    }
+
+    // Build per-phase envelopes from known-good recordings and write them to
+    // envelopePath. Each recording is read in one sequential pass (no seeking)
+    // that does not keep it in the page cache (see StreamingRead).
+    // Recordings are spread over worker threads pinned round-robin to NUMA
+    // nodes; each worker decodes into buffers on its own node.
+    bool buildEnvelope(const std::vector<std::string>& videoPaths,
+                       const std::vector<LineSegment>& lines,
+                       int phaseBins,
+                       const std::string& envelopePath) {
+        try {
+            if (videoPaths.empty() || lines.empty() || phaseBins <= 0) {
+                std::cerr << "Error: Envelope needs recordings, lines and phase bins" << std::endl;
+                return false;
+            }
+            
+            EnvelopeAccumulator accumulator(lines, phaseBins);
+            std::mutex accumulatorMutex;
+            std::atomic<size_t> nextRecording{0};
+            
+            size_t workerCount = std::min<size_t>(videoPaths.size(),
+                                                  std::max(1u, std::thread::hardware_concurrency()));
+            int nodeCount = numa::topology().nodeCount();
+            std::vector<std::thread> workers;
+            
+            // Exceptions must not leave a worker (std::terminate); the first
+            // one is reported after all workers have finished
+            std::mutex failureMutex;
+            std::string failure;
+            
+            for (size_t w = 0; w < workerCount; w++) {
+                workers.emplace_back([&, w] {
+                    if (nodeCount > 1) {
+                        numa::pinCurrentThreadToNode(static_cast<int>(w % nodeCount));
+                    }
+                    
+                    try {
+                        std::vector<std::array<float, MEASURE_COUNT>> measurements;
+                        std::vector<bool> valid;
+                        std::vector<std::pair<size_t, float>> samples;  // (slot index, value)
+                        StreamingRead streaming;
+                        cv::Mat decoded;  // Reused across recordings of the same size
+                        decoded.allocator = numa::largeBufferAllocator();
+                        
+                        for (size_t i = nextRecording++; i < videoPaths.size(); i = nextRecording++) {
+                            const std::string& path = videoPaths[i];
+                            cv::VideoCapture recording(path);
+                            if (!recording.isOpened()) {
+                                std::cerr << "Warning: Skipping unreadable recording: " << path << std::endl;
+                                continue;
+                            }
+                            
+                            int frames = static_cast<int>(recording.get(cv::CAP_PROP_FRAME_COUNT));
+                            Frame frame;
+                            int frameNumber = 0;
+                            samples.clear();
+                            streaming.open(path);
+                            
+                            while (recording.read(decoded)) {
+                                if (frames > 0) {
+                                    streaming.advance(static_cast<double>(frameNumber) / frames);
+                                }
+                                int bin = accumulator.envelope.phaseBin(frameNumber, frames);
+                                wrapFrame(decoded, frame);
+                                
+                                if (measureLines(frame, lines, measurements, valid)) {
+                                    for (size_t l = 0; l < lines.size(); l++) {
+                                        if (!valid[l]) continue;
+                                        for (int m = 0; m < MEASURE_COUNT; m++) {
+                                            samples.push_back({ accumulator.envelope.index(bin, static_cast<int>(l), m),
+                                                                measurements[l][m] });
+                                        }
+                                    }
+                                }
+                                
+                                frameNumber++;
+                            }
+                            streaming.close();
+                            
+                            std::lock_guard<std::mutex> lock(accumulatorMutex);
+                            for (const auto& sample : samples) {
+                                accumulator.add(sample.first, sample.second);
+                            }
+                            accumulator.envelope.recordings++;
+                            std::cout << "Envelope: " << path << " (" << frameNumber << " frames)" << std::endl;
+                        }
+                    } catch (const std::exception& e) {
+                        std::lock_guard<std::mutex> lock(failureMutex);
+                        if (failure.empty()) {
+                            failure = e.what();
+                        }
+                        nextRecording = videoPaths.size();  // Other workers stop after their recording
+                    }
+                });
+            }
+            
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            
+            if (!failure.empty()) {
+                std::cerr << "Exception building envelope: " << failure << std::endl;
+                return false;
+            }
+            
+            if (accumulator.envelope.recordings == 0) {
+                std::cerr << "Error: No readable recordings for envelope" << std::endl;
+                return false;
+            }
+            
+            return accumulator.finish().save(envelopePath);
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Exception building envelope: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    // Score a recording against a stored envelope in a single streaming pass
+    // that does not keep it in the page cache.
+    // Frames with any measurement outside the band (widened by tolerance) are
+    // reported; usePercentiles selects the p05..p95 band instead of min..max.
+    std::vector<EnvelopeViolation> scoreEnvelope(const std::string& videoPath,
+                                                 const std::string& envelopePath,
+                                                 float tolerance,
+                                                 bool usePercentiles,
+                                                 int& framesScored) {
+        std::vector<EnvelopeViolation> violations;
+        framesScored = 0;
+        
+        try {
+            Envelope envelope;
+            if (!envelope.load(envelopePath)) {
+                return violations;
+            }
+            
+            cv::VideoCapture recording(videoPath);
+            if (!recording.isOpened()) {
+                std::cerr << "Error: Could not open video file: " << videoPath << std::endl;
+                return violations;
+            }
+            
+            int frames = static_cast<int>(recording.get(cv::CAP_PROP_FRAME_COUNT));
+            std::vector<std::array<float, MEASURE_COUNT>> measurements;
+            std::vector<bool> valid;
+            cv::Mat decoded;
+            decoded.allocator = numa::largeBufferAllocator();
+            Frame frame;
+            StreamingRead streaming;
+            streaming.open(videoPath);
             
-            // Analyze each pixel
-            for (const auto& pixel : linePixels) {
-                int x = pixel.first;
-                int y = pixel.second;
+            while (recording.read(decoded)) {
+                int frameNumber = framesScored++;
+                if (frames > 0) {
+                    streaming.advance(static_cast<double>(frameNumber) / frames);
+                }
+                int bin = envelope.phaseBin(frameNumber, frames);
+                wrapFrame(decoded, frame);
                 
-                // Get BGR values (OpenCV uses BGR, not RGB)
-                cv::Vec3b bgr = frame.at<cv::Vec3b>(y, x);
-                int b = bgr[0];
-                int g = bgr[1];
-                int r = bgr[2];
+                if (!measureLines(frame, envelope.lines, measurements, valid)) continue;
                 
-                float temp = getPixelTemperature(r, g, b);
+                for (size_t l = 0; l < envelope.lines.size(); l++) {
+                    if (!valid[l]) continue;
+                    for (int m = 0; m < MEASURE_COUNT; m++) {
+                        const EnvelopeBand& band = envelope.bands[envelope.index(bin, static_cast<int>(l), m)];
+                        if (!band.valid) continue;
+                        
+                        float lo = (usePercentiles ? band.p05 : band.lo) - tolerance;
+                        float hi = (usePercentiles ? band.p95 : band.hi) + tolerance;
+                        float value = measurements[l][m];
+                        
+                        if (value < lo || value > hi) {
+                            violations.push_back({ frameNumber, bin, static_cast<int>(l), m, value, lo, hi });
+                        }
+                    }
+                }
+            }
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Exception scoring envelope: " << e.what() << std::endl;
+        }
+        
+        return violations;
+    }
+
+    // Convert frames [startFrame, endFrame] (every frameStep-th) of the loaded
+    // video into a temperature volume in one sequential pass. Neither the
+    // recording nor the volume is kept in the page cache.
+    bool exportVolume(const std::string& volumePath, TempFormat format,
+                      int startFrame, int endFrame, int frameStep, int& framesWritten) {
+        framesWritten = 0;
+        
+        try {
+            if (videoPath.empty()) {
+                std::cerr << "Error: Video not loaded" << std::endl;
+                return false;
+            }
+            
+            cv::VideoCapture recording(videoPath);
+            if (!recording.isOpened()) {
+                std::cerr << "Error: Could not open video file: " << videoPath << std::endl;
+                return false;
+            }
+            
+            startFrame = std::max(0, startFrame);
+            endFrame = std::min(endFrame, totalFrames - 1);
+            frameStep = std::max(1, frameStep);
+            
+            TemperatureVolume layout;
+            layout.width = frameWidth;
+            layout.height = frameHeight;
+            layout.firstFrame = startFrame;
+            layout.frameStep = frameStep;
+            layout.format = format;
+            layout.fps = fps / frameStep;
+            
+            VolumeWriter writer;
+            if (!writer.open(volumePath, layout)) {
+                return false;
+            }
+            
+            if (startFrame > 0) {
+                recording.set(cv::CAP_PROP_POS_FRAMES, startFrame);
+            }
+            
+            cv::Mat decoded;
+            decoded.allocator = numa::largeBufferAllocator();
+            Frame frame;
+            std::vector<float> plane;
+            StreamingRead streaming;
+            streaming.open(videoPath);
+            
+            for (int frameNumber = startFrame; frameNumber <= endFrame && recording.read(decoded); frameNumber++) {
+                streaming.advance(static_cast<double>(frameNumber) / std::max(1, totalFrames));
+                if ((frameNumber - startFrame) % frameStep != 0) continue;
                 
-                if (temp >= 0) {
-                    temperatures.push_back(temp);
-                } else {
-                    // Use interpolated value or skip
-                    temperatures.push_back(0.0f);
+                if (decoded.cols != frameWidth || decoded.rows != frameHeight) {
+                    std::cerr << "Error: Frame " << frameNumber << " has a different size" << std::endl;
+                    return false;
+                }
+                
+                wrapFrame(decoded, frame);
+                temperaturePlane(frame, plane);
+                if (!writer.append(plane.data())) {
+                    std::cerr << "Error: Could not write temperature volume: " << volumePath << std::endl;
+                    return false;
                 }
+                framesWritten++;
             }
             
+            return writer.finish();
+            
         } catch (const std::exception& e) {
-            std::cerr << "Exception analyzing line: " << e.what() << std::endl;
+            std::cerr << "Exception exporting volume: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    // Open a temperature volume to serve tiles from; encoded tiles of the
+    // previous volume are dropped
+    bool openVolume(const std::string& volumePath) {
+        volumeReadAhead.stop();
+        cacheManager.clear(CacheClass::TEMPERATURE);
+        lastVolumeFrame = -1;
+        if (!volumeReader.open(volumePath)) {
+            return false;
         }
         
-        return temperatures;
+        bool readingAhead = volumeReadAhead.start(volumePath, volumeReader.volume, [this](int index, const std::vector<uint16_t>& plane) {
+            const TemperatureVolume& volume = volumeReader.volume;
+            int frameNumber = volume.firstFrame + index * volume.frameStep;
+            int tileSize = readAheadTileSize;
+            if (!cacheManager.contains(CacheClass::TEMPERATURE, volumeTileKey(frameNumber, tileSize))) {
+                cacheVolumeTiles(frameNumber, tileSize, plane, 0.0);
+            }
+        });
+        if (!readingAhead) {
+            std::cerr << "Warning: No read-ahead for temperature volume: " << volumePath << std::endl;
+        }
+        return true;
+    }
+    
+    bool hasVolume() const { return volumeReader.isOpen(); }
+    const TemperatureVolume& getVolume() const { return volumeReader.volume; }
+    const char* getVolumeIoBackend() const { return volumeReader.ioBackend(); }
+    
+    // Encoded tiles of source frames from the volume, nullptr for frames the
+    // volume does not hold. Frames not cached yet are read in one batch, so
+    // their reads are in flight together. Cached as temperature data.
+    std::vector<std::shared_ptr<const std::vector<VolumeTile>>> getVolumeTiles(const std::vector<int>& frameNumbers,
+                                                                               int tileSize) {
+        std::vector<std::shared_ptr<const std::vector<VolumeTile>>> result(frameNumbers.size());
+        
+        try {
+            if (!volumeReader.isOpen() || tileSize <= 0) return result;
+            
+            const TemperatureVolume& volume = volumeReader.volume;
+            std::vector<int> indices;
+            std::vector<size_t> slots;
+            for (size_t i = 0; i < frameNumbers.size(); i++) {
+                int index = volume.indexOf(frameNumbers[i]);
+                if (index < 0) continue;
+                
+                result[i] = cacheManager.get<std::vector<VolumeTile>>(CacheClass::TEMPERATURE,
+                                                                      volumeTileKey(frameNumbers[i], tileSize));
+                if (!result[i]) {
+                    indices.push_back(index);
+                    slots.push_back(i);
+                }
+            }
+            
+            if (indices.empty()) return result;
+            
+            int64_t startTicks = cv::getTickCount();
+            std::vector<std::vector<uint16_t>> planes;
+            volumeReader.readFrames(indices, planes);
+            double readMs = elapsedMs(startTicks) / indices.size();
+            
+            for (size_t k = 0; k < slots.size(); k++) {
+                if (!planes[k].empty()) {
+                    result[slots[k]] = cacheVolumeTiles(frameNumbers[slots[k]], tileSize, planes[k], readMs);
+                }
+            }
+            
+        } catch (const std::exception& e) {
+            std::cerr << "Exception reading volume tiles: " << e.what() << std::endl;
+        }
+        
+        return result;
+    }
+    
+    // Encoded tiles of a source frame from the volume, nullptr if the volume
+    // does not hold the frame. Playback moving forward reads the next frames
+    // ahead in the background.
+    std::shared_ptr<const std::vector<VolumeTile>> getVolumeTiles(int frameNumber, int tileSize) {
+        std::shared_ptr<const std::vector<VolumeTile>> tiles = getVolumeTiles(std::vector<int>{ frameNumber }, tileSize)[0];
+        if (tiles) {
+            readAheadVolume(frameNumber, tileSize);
+        }
+        return tiles;
+    }
+
+    // Queue frames for background decoding, most likely first
+    void prefetchFrames(const std::vector<int>& frames) {
+        std::vector<int> wanted;
+        wanted.reserve(frames.size());
+        
+        for (int frame : frames) {
+            if (frame >= 0 && frame < totalFrames && !frameService.pending(videoKey, frame)) {
+                wanted.push_back(frame);
+            }
+        }
+        
+        prefetcher.request(wanted);
+    }
+    
+    // Global budget and per-class weights; weights <= 0 keep their current value
+    void configureCache(size_t budgetBytes, const double weights[static_cast<int>(CacheClass::COUNT)]) {
+        cacheManager.configure(budgetBytes, weights);
+    }
+    
+    // Format for cached temperature data; cached results are dropped
+    void setTemperatureFormat(TempFormat format) {
+        storageFormat = static_cast<int>(format);
+        cacheManager.clear(CacheClass::RESULT);
+    }
+    
+    TempFormat getTemperatureFormat() const { return static_cast<TempFormat>(storageFormat.load()); }
+    
+    const CacheManager& getCacheManager() const { return cacheManager; }
+    size_t getPrefetchedCount() const { return prefetcher.getPrefetchedCount(); }
+    const FrameService& getFrameService() const { return frameService; }
+    FrameService& getFrameService() { return frameService; }
+    uint64_t getVideoKey() const { return videoKey; }
+    
+    // Cached frame of the loaded video, or decode(cv::Mat&) -> bool it on
+    // the calling thread (see FrameService::get)
+    template <typename Decode>
+    Frame getSharedFrame(int frameNumber, Decode&& decode) {
+        return frameService.get(videoKey, frameNumber, std::forward<Decode>(decode));
     }
 
     // Getter functions for video properties
+    const std::string& getVideoPath() const { return videoPath; }
+    FrameRing& getBroadcastRing() { return broadcastRing; }
     int getTotalFrames() const { return totalFrames; }
     double getFPS() const { return fps; }
     int getFrameWidth() const { return frameWidth; }
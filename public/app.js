@@ -4,6 +4,7 @@ let video;
 let canvas;
 let ctx;
 let chart1, chart2;
+let profileChart1, profileChart2; // Renderers of chart1 / chart2 (see profile-chart.js)
 let videoInfo = {};
 
 // Line positions (will be calculated relative to canvas size)
@@ -18,6 +19,29 @@ const DRAG_THRESHOLD = 15;
 let isConnected = false;
 let isEngineReady = false;
 
+// Live monitoring mode (open the page with ?live): charts follow the live
+// capture on the server instead of the recorded video
+const liveMode = new URLSearchParams(window.location.search).has('live');
+
+// Active live alarms by rule id
+const activeAlarms = new Set();
+
+// Compact profile encoding requested from the server ('delta' = lossless
+// 0.1 °C deltas to the previous profile, 'u16', 'f16', or null for plain
+// JSON arrays)
+const PROFILE_ENCODING = 'delta';
+
+// Delta decoding state per chart line (see profile-codec.js)
+const profileStreams = { line1: new ProfileStream(), line2: new ProfileStream() };
+
+// Tile mode (open the page with ?tiles): fetch the temperature tiles of a
+// frame once and sample lines locally while it stays on screen. Needs a
+// temperature volume on the server; otherwise lines are analyzed there.
+const tileMode = new URLSearchParams(window.location.search).has('tiles');
+const tileSampler = new TileSampler();
+let requestedTiles = -1; // Frame whose tiles are on their way
+let missingTiles = -1;   // Last frame the volume does not hold
+
 // Initialize when page loads
 window.addEventListener('DOMContentLoaded', () => {
     initializeElements();
@@ -27,6 +51,10 @@ window.addEventListener('DOMContentLoaded', () => {
     setupCharts();
     setupControls();
     
+    if (tileMode) {
+        tileSampler.load();
+    }
+    
     // Wait for video metadata to calculate proper sizes
     video.addEventListener('loadedmetadata', () => {
         setTimeout(() => {
@@ -56,6 +84,11 @@ function setupWebSocket() {
     
     ws.onopen = () => {
         isConnected = true;
+        
+        // A new connection starts new delta streams on the server
+        profileStreams.line1.reset();
+        profileStreams.line2.reset();
+        requestedTiles = -1;
     };
     
     ws.onmessage = (event) => {
@@ -78,6 +111,18 @@ function handleWebSocketMessage(message) {
         case 'analysisResult':
             handleAnalysisResult(message.data);
             break;
+        case 'liveResult':
+            handleLiveResult(message.data);
+            break;
+        case 'alarm':
+            handleAlarm(message.data);
+            break;
+        case 'liveEnded':
+            handleLiveEnded(message.data);
+            break;
+        case 'tiles':
+            handleTiles(message.data);
+            break;
     }
 }
 
@@ -103,10 +148,115 @@ function handleVideoInfo(data) {
     }
 }
 
+// Convert an IEEE half-precision value to a number
+function halfToFloat(half) {
+    const exponent = (half >> 10) & 0x1f;
+    const mantissa = half & 0x3ff;
+    const sign = half & 0x8000 ? -1 : 1;
+    
+    if (exponent === 0) return sign * mantissa * Math.pow(2, -24);
+    if (exponent === 31) return mantissa ? NaN : sign * Infinity;
+    return sign * (1 + mantissa / 1024) * Math.pow(2, exponent - 15);
+}
+
+// Temperatures of a line result, decoding compact encodings
+function decodeProfile(line, stream) {
+    if (!line.encoded) return line.temperatures;
+    
+    if (line.encoded.format === 'delta') {
+        const bytes = Uint8Array.from(atob(line.encoded.data), c => c.charCodeAt(0));
+        return profileStreams[stream].decode(bytes);
+    }
+    
+    return decodeSamples(line.encoded);
+}
+
+// Temperatures of a u16 / f16 encoded series
+function decodeSamples(encoded) {
+    const bytes = Uint8Array.from(atob(encoded.data), c => c.charCodeAt(0));
+    const view = new DataView(bytes.buffer);
+    const temperatures = new Array(bytes.length / 2);
+    
+    for (let i = 0; i < temperatures.length; i++) {
+        const value = view.getUint16(i * 2, true);
+        temperatures[i] = encoded.format === 'f16' ? halfToFloat(value) : value / 10;
+    }
+    
+    return temperatures;
+}
+
+// Min/max/avg series of a bucketed line result
+function decodeBuckets(buckets) {
+    const series = (values) => Array.isArray(values) ? values : decodeSamples(values);
+    return {
+        length: buckets.length,
+        min: series(buckets.min),
+        max: series(buckets.max),
+        avg: series(buckets.avg)
+    };
+}
+
+// Queue a line result on its chart, whether full resolution or bucketed
+function pushLineResult(profileChart, line, stream, tweenMs) {
+    if (line.buckets) {
+        profileChart.pushBuckets(decodeBuckets(line.buckets), tweenMs);
+    } else {
+        profileChart.push(decodeProfile(line, stream), tweenMs);
+    }
+}
+
 // Handle analysis results
 function handleAnalysisResult(data) {
-    updateChart(chart1, data.line1.temperatures, '#2563eb', false); // Horizontal chart
-    updateChart(chart2, data.line2.temperatures, '#059669', true);  // Vertical chart
+    // When the server skips frames under load, interpolate between the
+    // profiles it does send over the frames that were skipped
+    const quality = data.quality;
+    const tweenMs = quality && !quality.refined && quality.frameSkip > 0
+        ? (quality.frameSkip + 1) * 1000 / (videoInfo.fps || 25)
+        : 0;
+    
+    pushLineResult(profileChart1, data.line1, 'line1', tweenMs); // Horizontal chart
+    pushLineResult(profileChart2, data.line2, 'line2', tweenMs); // Vertical chart
+}
+
+// Handle the temperature tiles of a frame
+function handleTiles(data) {
+    requestedTiles = -1;
+    
+    if (data.available) {
+        tileSampler.setFrame(data.frameNum, data.width, data.height, data.tiles);
+        requestAnalysis();
+    } else {
+        // Frame not in the volume: analyze it on the server instead
+        missingTiles = data.frameNum;
+        sendAnalyzeLine(data.frameNum);
+    }
+}
+
+// Handle live capture results (same chart layout as recorded analysis)
+function handleLiveResult(data) {
+    if (data.lines.length < 2) return;
+    
+    updateFrameInfo(data.frame);
+    profileChart1.push(data.lines[0].temperatures);
+    profileChart2.push(data.lines[1].temperatures);
+}
+
+// The live source ran out; moving a line subscribes (and starts) again
+function handleLiveEnded(data) {
+    activeAlarms.clear();
+    document.getElementById('alarmInfo').textContent = `Live source ended after frame ${data.lastFrame}`;
+}
+
+// Handle alarm events raised or cleared by the live rule engine
+function handleAlarm(alarm) {
+    if (alarm.state === 'raised') {
+        activeAlarms.add(alarm.rule);
+    } else {
+        activeAlarms.delete(alarm.rule);
+    }
+    
+    document.getElementById('alarmInfo').textContent =
+        activeAlarms.size > 0 ? `Alarm: ${[...activeAlarms].join(', ')}` : '';
 }
 
 // Setup video element
@@ -124,6 +274,11 @@ function setupVideo() {
             requestAnalysis();
         }
     });
+    
+    // Refine to full quality once playback stops
+    video.addEventListener('pause', () => {
+        requestAnalysis();
+    });
 }
 
 // Setup canvas for line drawing
@@ -153,6 +308,8 @@ function setupCharts() {
             maintainAspectRatio: false,
             plugins: { legend: { display: false } },
             animation: { duration: 0 },
+            parsing: false,     // Points are {x, y} from ProfileChart
+            normalized: true,
             interaction: { intersect: false, mode: 'index' },
             scales: {
                 x: { 
@@ -196,6 +353,8 @@ function setupCharts() {
             maintainAspectRatio: false,
             plugins: { legend: { display: false } },
             animation: { duration: 0 },
+            parsing: false,     // Points are {x, y} from ProfileChart
+            normalized: true,
             interaction: { intersect: false, mode: 'index' },
             indexAxis: 'y', // This swaps the axes
             scales: {
@@ -222,6 +381,9 @@ function setupCharts() {
             }
         }
     });
+    
+    profileChart1 = new ProfileChart(chart1, false);
+    profileChart2 = new ProfileChart(chart2, true);
 }
 
 // Setup controls
@@ -428,16 +590,58 @@ function updateFrameInfo(frameNumber) {
 function requestAnalysis() {
     if (!isConnected || !isEngineReady) return;
     
+    if (liveMode) {
+        subscribeLive();
+        return;
+    }
+    
     const currentFrame = Math.floor(video.currentTime * (videoInfo.fps || 1));
+    
+    if (tileMode && videoInfo.volume && currentFrame !== missingTiles) {
+        if (tileSampler.hasFrame(currentFrame)) {
+            profileChart1.push(tileSampler.sampleLine(convertToVideoCoords(line1)));
+            profileChart2.push(tileSampler.sampleLine(convertToVideoCoords(line2)));
+        } else if (requestedTiles !== currentFrame) {
+            requestedTiles = currentFrame;
+            ws.send(JSON.stringify({
+                type: 'requestTiles',
+                data: { frameNum: currentFrame }
+            }));
+        }
+        return;
+    }
+    
+    sendAnalyzeLine(currentFrame);
+}
+
+function sendAnalyzeLine(currentFrame) {
     const videoLine1 = convertToVideoCoords(line1);
     const videoLine2 = convertToVideoCoords(line2);
     
+    // While playing or dragging, ask for one min/max bucket per chart column;
+    // a still frame is fetched at full resolution
+    const fullResolution = video.paused && !dragging;
+    const width = fullResolution ? undefined : Math.max(profileChart1.columns(), profileChart2.columns());
+    
     ws.send(JSON.stringify({
         type: 'analyzeLine',
         data: {
             frameNum: currentFrame,
             line1: videoLine1,
-            line2: videoLine2
+            line2: videoLine2,
+            playing: !video.paused,
+            encoding: PROFILE_ENCODING,
+            width
+        }
+    }));
+}
+
+// (Re)subscribe to live results for the current line positions
+function subscribeLive() {
+    ws.send(JSON.stringify({
+        type: 'subscribeLive',
+        data: {
+            lines: [convertToVideoCoords(line1), convertToVideoCoords(line2)]
         }
     }));
 }
@@ -455,36 +659,6 @@ function convertToVideoCoords(line) {
     };
 }
 
-function updateChart(chart, temperatures, color, isVertical = false) {
-    if (!temperatures || temperatures.length === 0) return;
-    
-    if (isVertical) {
-        // Vertical chart: Temperature on X-axis, Position on Y-axis
-        // Reverse temperatures so bottom of line (index 0) = bottom of chart (0%)
-        const reversedTemps = [...temperatures].reverse();
-        
-        // Create position labels from 0% to 100%
-        const positions = reversedTemps.map((_, index) => 
-            Math.round((index / (reversedTemps.length - 1)) * 100)
-        );
-        
-        // For indexAxis: 'y' charts, we need to structure data differently
-        chart.data.labels = positions;
-        chart.data.datasets[0].data = reversedTemps;
-    } else {
-        // Horizontal chart: Position on X-axis, Temperature on Y-axis
-        const positions = temperatures.map((_, index) => 
-            Math.round((index / (temperatures.length - 1)) * 100)
-        );
-        
-        chart.data.labels = positions;
-        chart.data.datasets[0].data = temperatures;
-    }
-    
-    chart.data.datasets[0].borderColor = color;
-    chart.update('none');
-}
-
 // Handle window resize
 window.addEventListener('resize', () => {
     // Debounce the resize to avoid excessive recalculations
@@ -493,6 +667,8 @@ window.addEventListener('resize', () => {
         adjustCanvasSize();
         adjustLinePositions();
         drawLines();
+        profileChart1.invalidate(); // Re-decimate for the new chart widths
+        profileChart2.invalidate();
         requestAnalysis();
     }, 250);
 });
\ No newline at end of file
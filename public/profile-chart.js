@@ -0,0 +1,276 @@
+// Profile chart rendering decoupled from the message rate
+//
+// Incoming profiles are copied into a typed-array ring and only mark the
+// chart dirty; drawing happens at most once per animation frame on the
+// newest profile, decimated to a min/max pair per pixel column. The work per
+// frame is bounded by the chart size, however long the profiles are or how
+// fast they arrive.
+
+const PROFILE_RING_SLOTS = 4;
+
+// Fixed number of reusable Float32Array slots holding the newest profiles
+class ProfileRing {
+    constructor(slots = PROFILE_RING_SLOTS) {
+        this.buffers = Array.from({ length: slots }, () => new Float32Array(1024));
+        this.lengths = new Int32Array(slots);
+        this.bucketed = new Uint8Array(slots); // Slot holds min/max pairs
+        this.head = -1; // Slot of the newest profile
+        this.count = 0;
+    }
+
+    push(temperatures, bucketed = false) {
+        const slot = (this.head + 1) % this.buffers.length;
+        if (this.buffers[slot].length < temperatures.length) {
+            this.buffers[slot] = new Float32Array(temperatures.length * 2);
+        }
+
+        this.buffers[slot].set(temperatures);
+        this.lengths[slot] = temperatures.length;
+        this.bucketed[slot] = bucketed ? 1 : 0;
+        this.head = slot;
+        this.count = Math.min(this.count + 1, this.buffers.length);
+    }
+
+    // Profile pushed back pushes before the newest one, or null
+    latest(back = 0) {
+        if (back >= this.count) return null;
+
+        const slot = (this.head - back + this.buffers.length) % this.buffers.length;
+        return this.buffers[slot].subarray(0, this.lengths[slot]);
+    }
+
+    isBucketed(back = 0) {
+        return back < this.count && this.bucketed[(this.head - back + this.buffers.length) % this.buffers.length] === 1;
+    }
+
+    clear() {
+        this.head = -1;
+        this.count = 0;
+    }
+}
+
+// Indices of the minimum and maximum sample of each of columns equal
+// ranges, in index order, written to out; returns how many were written.
+// Profiles of up to two samples per column are kept whole.
+function decimateMinMax(values, columns, out) {
+    const length = values.length;
+
+    if (length <= columns * 2) {
+        for (let i = 0; i < length; i++) {
+            out[i] = i;
+        }
+        return length;
+    }
+
+    let count = 0;
+    for (let column = 0; column < columns; column++) {
+        const start = Math.floor(column * length / columns);
+        const end = Math.floor((column + 1) * length / columns);
+        let min = start;
+        let max = start;
+
+        for (let i = start + 1; i < end; i++) {
+            if (values[i] < values[min]) {
+                min = i;
+            } else if (values[i] > values[max]) {
+                max = i;
+            }
+        }
+
+        out[count++] = Math.min(min, max);
+        if (min !== max) {
+            out[count++] = Math.max(min, max);
+        }
+    }
+
+    return count;
+}
+
+// Decimated points of a profile: position along the line (%) and value
+class ProfileSeries {
+    constructor() {
+        this.positions = new Float32Array(0);
+        this.values = new Float32Array(0);
+        this.count = 0;
+    }
+
+    reserve(count) {
+        if (this.positions.length < count) {
+            this.positions = new Float32Array(count);
+            this.values = new Float32Array(count);
+        }
+        this.count = count;
+    }
+
+    copyFrom(other) {
+        this.reserve(other.count);
+        this.positions.set(other.positions.subarray(0, other.count));
+        this.values.set(other.values.subarray(0, other.count));
+    }
+}
+
+// A Chart.js line chart showing the newest profile of a line. Vertical
+// charts (indexAxis 'y') show index 0 of the profile at the bottom.
+class ProfileChart {
+    constructor(chart, isVertical) {
+        this.chart = chart;
+        this.isVertical = isVertical;
+        this.ring = new ProfileRing();
+        this.indices = new Int32Array(0);
+        this.from = new ProfileSeries();   // Shown when the tween started
+        this.to = new ProfileSeries();     // Newest profile
+        this.shown = new ProfileSeries();  // Currently drawn
+        this.points = [];                  // Reused {x, y} objects
+        this.dirty = false;
+        this.pendingTween = 0;
+        this.tweenMs = 0;
+        this.tweenStart = 0;
+        this.frame = null;
+    }
+
+    // Queue a profile; with tweenMs the chart interpolates from what it
+    // currently shows over that time (profiles of equal length only)
+    push(temperatures, tweenMs = 0) {
+        this.queue(temperatures, false, tweenMs);
+    }
+
+    // Queue a profile reduced on the server to min/max/avg buckets (one per
+    // column, see analyzeLine width); drawn as each bucket's min and max
+    pushBuckets(buckets, tweenMs = 0) {
+        const pairs = new Float32Array(buckets.min.length * 2);
+        for (let i = 0; i < buckets.min.length; i++) {
+            pairs[i * 2] = buckets.min[i];
+            pairs[i * 2 + 1] = buckets.max[i];
+        }
+        this.queue(pairs, true, tweenMs);
+    }
+
+    queue(values, bucketed, tweenMs) {
+        if (!values || values.length === 0) return;
+
+        const previous = this.ring.latest();
+        const comparable = previous && previous.length === values.length && this.ring.isBucketed() === bucketed;
+        this.pendingTween = tweenMs && comparable ? tweenMs : 0;
+        this.ring.push(values, bucketed);
+        this.dirty = true;
+        this.schedule();
+    }
+
+    // Redraw the newest profile, e.g. after the chart was resized
+    invalidate() {
+        if (!this.ring.latest()) return;
+
+        this.pendingTween = 0;
+        this.dirty = true;
+        this.schedule();
+    }
+
+    schedule() {
+        if (this.frame === null) {
+            this.frame = requestAnimationFrame(now => this.render(now));
+        }
+    }
+
+    // Pixel columns along the position axis
+    columns() {
+        const area = this.chart.chartArea;
+        const size = area
+            ? (this.isVertical ? area.bottom - area.top : area.right - area.left)
+            : (this.isVertical ? this.chart.height : this.chart.width);
+        return Math.max(1, Math.round(size));
+    }
+
+    // Bucket b of n sits at the middle of its range of the line. Points are
+    // emitted in ascending position, which Chart.js assumes with parsing off
+    // (the vertical chart has the start of the line at 100)
+    bucketPoints(pairs, series) {
+        const buckets = pairs.length / 2;
+        series.reserve(pairs.length);
+
+        let count = 0;
+        for (let i = 0; i < buckets; i++) {
+            const b = this.isVertical ? buckets - 1 - i : i;
+            const center = (b + 0.5) / buckets * 100;
+            const position = this.isVertical ? 100 - center : center;
+            const min = pairs[b * 2];
+            const max = pairs[b * 2 + 1];
+
+            series.positions[count] = position;
+            series.values[count++] = min;
+            if (max !== min) {
+                series.positions[count] = position;
+                series.values[count++] = max;
+            }
+        }
+
+        series.count = count;
+    }
+
+    decimate(temperatures, series) {
+        const columns = this.columns();
+        if (this.indices.length < columns * 2) {
+            this.indices = new Int32Array(columns * 2);
+        }
+
+        const count = decimateMinMax(temperatures, columns, this.indices);
+        const last = Math.max(1, temperatures.length - 1);
+        series.reserve(count);
+
+        // Ascending position, as in bucketPoints
+        for (let i = 0; i < count; i++) {
+            const index = this.indices[this.isVertical ? count - 1 - i : i];
+            series.positions[i] = (this.isVertical ? last - index : index) / last * 100;
+            series.values[i] = temperatures[index];
+        }
+    }
+
+    render(now) {
+        this.frame = null;
+
+        if (this.dirty) {
+            this.dirty = false;
+            this.from.copyFrom(this.shown);
+            if (this.ring.isBucketed()) {
+                this.bucketPoints(this.ring.latest(), this.to);
+            } else {
+                this.decimate(this.ring.latest(), this.to);
+            }
+            this.tweenMs = this.pendingTween && this.from.count === this.to.count ? this.pendingTween : 0;
+            this.tweenStart = now;
+        }
+
+        const t = this.tweenMs ? Math.min(1, (now - this.tweenStart) / this.tweenMs) : 1;
+        if (t >= 1) {
+            this.shown.copyFrom(this.to);
+        } else {
+            this.shown.reserve(this.to.count);
+            for (let i = 0; i < this.to.count; i++) {
+                this.shown.positions[i] = this.from.positions[i] + (this.to.positions[i] - this.from.positions[i]) * t;
+                this.shown.values[i] = this.from.values[i] + (this.to.values[i] - this.from.values[i]) * t;
+            }
+        }
+
+        this.draw();
+
+        if (t < 1) {
+            this.schedule();
+        }
+    }
+
+    draw() {
+        const { positions, values, count } = this.shown;
+
+        while (this.points.length < count) {
+            this.points.push({ x: 0, y: 0 });
+        }
+
+        for (let i = 0; i < count; i++) {
+            const point = this.points[i];
+            point.x = this.isVertical ? values[i] : positions[i];
+            point.y = this.isVertical ? positions[i] : values[i];
+        }
+
+        this.chart.data.datasets[0].data = this.points.slice(0, count);
+        this.chart.update('none');
+    }
+}
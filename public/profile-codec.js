@@ -0,0 +1,105 @@
+// Decoder for delta-compressed line profiles and temperature tiles
+// (see native/profile_codec.cpp)
+//
+// Each stream (one per chart line) keeps the previously decoded profile as
+// 0.1 °C fixed point; key frames replace it, delta frames are added to it.
+// Tiles code their first row as a key frame and each further row as a delta
+// frame against the row above.
+
+const PROFILE_KEY = 0;
+const PROFILE_DELTA = 1;
+const PROFILE_BLOCK = 64;
+const PROFILE_ESCAPE = 24;
+const ZIGZAG_BITS = 17;
+
+class ProfileStream {
+    constructor() {
+        this.previous = null; // Uint16Array of the last decoded profile
+    }
+
+    // Decode one encoded profile (Uint8Array) into temperatures in °C
+    decode(bytes) {
+        const count = (bytes[1] | (bytes[2] << 8) | (bytes[3] << 16) | (bytes[4] << 24)) >>> 0;
+        const current = new Uint16Array(count);
+
+        if (bytes[0] === PROFILE_KEY) {
+            for (let i = 0; i < count; i++) {
+                current[i] = bytes[5 + i * 2] | (bytes[6 + i * 2] << 8);
+            }
+        } else if (bytes[0] === PROFILE_DELTA) {
+            if (!this.previous || this.previous.length !== count) {
+                throw new Error('Delta profile without matching key profile');
+            }
+            decodeProfileDelta(bytes, this.previous, current);
+        } else {
+            throw new Error(`Unknown profile frame type ${bytes[0]}`);
+        }
+
+        this.previous = current;
+
+        const temperatures = new Array(count);
+        for (let i = 0; i < count; i++) {
+            temperatures[i] = current[i] / 10;
+        }
+        return temperatures;
+    }
+
+    reset() {
+        this.previous = null;
+    }
+}
+
+// Add the Rice-coded differences of a delta frame to previous, writing
+// current in ascending order (current may overlap previous further ahead)
+function decodeProfileDelta(bytes, previous, current) {
+    let position = 5 * 8; // Bit position, MSB first
+    const readBit = () => {
+        const bit = (bytes[position >> 3] >> (7 - (position & 7))) & 1;
+        position++;
+        return bit;
+    };
+    const readBits = (count) => {
+        let value = 0;
+        for (let i = 0; i < count; i++) {
+            value = value * 2 + readBit();
+        }
+        return value;
+    };
+
+    for (let start = 0; start < current.length; start += PROFILE_BLOCK) {
+        const end = Math.min(current.length, start + PROFILE_BLOCK);
+        const k = readBits(4);
+
+        for (let i = start; i < end; i++) {
+            let quotient = 0;
+            while (quotient < PROFILE_ESCAPE && readBit()) {
+                quotient++;
+            }
+
+            const zigzag = quotient === PROFILE_ESCAPE
+                ? readBits(ZIGZAG_BITS)
+                : quotient * (1 << k) + readBits(k);
+            const delta = (zigzag >>> 1) ^ -(zigzag & 1);
+            current[i] = previous[i] + delta;
+        }
+    }
+}
+
+// Decode a width x height tile into a Uint16Array of 0.1 °C samples
+function decodeTile(bytes, width, height) {
+    const firstLength = (bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (bytes[3] << 24)) >>> 0;
+    const values = new Uint16Array(width * height);
+
+    const first = bytes.subarray(4, 4 + firstLength);
+    for (let i = 0; i < width; i++) {
+        values[i] = first[5 + i * 2] | (first[6 + i * 2] << 8);
+    }
+
+    if (height > 1) {
+        // Row r is predicted from row r - 1: previous and current overlap
+        const rest = width * (height - 1);
+        decodeProfileDelta(bytes.subarray(4 + firstLength), values.subarray(0, rest), values.subarray(width));
+    }
+
+    return values;
+}
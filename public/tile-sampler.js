@@ -0,0 +1,99 @@
+// Client-side line sampling from temperature tiles (see requestTiles on the
+// server). The tiles of a frame are decoded into one 0.1 °C plane and line
+// profiles are sampled locally, so dragging a line needs no round trip.
+//
+// Sampling runs in wasm/sampler.wasm (built by wasm/build.sh); without it
+// the same Bresenham walk runs in JS.
+
+class TileSampler {
+    constructor() {
+        this.wasm = null;     // Exports of sampler.wasm once loaded
+        this.plane = null;    // Uint16Array of the current frame
+        this.planeInWasm = false;  // plane is the frame buffer of sampler.wasm
+        this.frameNum = -1;
+        this.width = 0;
+        this.height = 0;
+    }
+
+    async load() {
+        try {
+            const response = fetch('wasm/sampler.wasm');
+            const { instance } = await WebAssembly.instantiateStreaming(response, {});
+            this.wasm = instance.exports;
+            console.log('✓ WebAssembly sampler loaded');
+        } catch (error) {
+            console.warn('✗ WebAssembly sampler unavailable, sampling in JS:', error.message);
+        }
+    }
+
+    hasFrame(frameNum) {
+        return this.plane !== null && this.frameNum === frameNum;
+    }
+
+    // Decode the tiles of a frame into the plane. The sampler may finish
+    // loading at any time; a frame decoded before that stays in JS.
+    setFrame(frameNum, width, height, tiles) {
+        if (this.wasm) {
+            const pointer = this.wasm.set_frame_size(width, height);
+            if (!pointer) throw new Error('Not enough WebAssembly memory for the frame');
+            // Views are taken after set_frame_size, which may grow the memory
+            this.plane = new Uint16Array(this.wasm.memory.buffer, pointer, width * height);
+            this.planeInWasm = true;
+        } else if (!this.plane || this.planeInWasm || this.width !== width || this.height !== height) {
+            this.plane = new Uint16Array(width * height);
+            this.planeInWasm = false;
+        }
+
+        for (const tile of tiles) {
+            const bytes = Uint8Array.from(atob(tile.data), c => c.charCodeAt(0));
+            const values = decodeTile(bytes, tile.width, tile.height);
+            for (let row = 0; row < tile.height; row++) {
+                const offset = (tile.y + row) * width + tile.x;
+                this.plane.set(values.subarray(row * tile.width, (row + 1) * tile.width), offset);
+            }
+        }
+
+        this.frameNum = frameNum;
+        this.width = width;
+        this.height = height;
+    }
+
+    // Temperatures in °C along a line in video coordinates, like the
+    // server's analyzeLine
+    sampleLine(line) {
+        if (this.planeInWasm) {
+            const count = this.wasm.sample_line(line.x1, line.y1, line.x2, line.y2);
+            const output = new Float32Array(this.wasm.memory.buffer, this.wasm.output_buffer(), count);
+            return Array.from(output);
+        }
+
+        const temperatures = [];
+        const dx = Math.abs(line.x2 - line.x1);
+        const dy = Math.abs(line.y2 - line.y1);
+        const sx = line.x1 < line.x2 ? 1 : -1;
+        const sy = line.y1 < line.y2 ? 1 : -1;
+        let err = dx - dy;
+        let x = line.x1;
+        let y = line.y1;
+
+        while (true) {
+            if (x >= 0 && x < this.width && y >= 0 && y < this.height) {
+                temperatures.push(this.plane[y * this.width + x] / 10);
+            }
+
+            if (x === line.x2 && y === line.y2) break;
+
+            const e2 = 2 * err;
+            if (e2 > -dy) {
+                err -= dy;
+                x += sx;
+            }
+            if (e2 < dx) {
+                err += dx;
+                y += sy;
+            }
+        }
+
+        return temperatures;
+    }
+}
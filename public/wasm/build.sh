@@ -0,0 +1,13 @@
+#!/bin/sh
+# Build sampler.wasm with clang (wasm32 target + wasm-ld) or emscripten.
+# The page falls back to the equivalent JS sampler when the file is missing.
+set -e
+cd "$(dirname "$0")"
+
+if command -v emcc >/dev/null 2>&1; then
+    emcc -O3 --no-entry -s STANDALONE_WASM=1 -s ALLOW_MEMORY_GROWTH=1 -o sampler.wasm sampler.c
+else
+    clang --target=wasm32 -O3 -nostdlib -Wl,--no-entry -Wl,--export-dynamic -o sampler.wasm sampler.c
+fi
+
+echo "✓ Built $(pwd)/sampler.wasm"
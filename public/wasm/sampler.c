@@ -0,0 +1,92 @@
+// Line sampling over a 0.1 °C temperature plane, compiled to WebAssembly
+// for public/tile-sampler.js (build with build.sh). No libc: the plane and
+// the output buffer live in linear memory after __heap_base.
+//
+// Rasterization matches ThermalEngine::getLinePixels: Bresenham from
+// (x1, y1) to (x2, y2), skipping pixels outside the frame.
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define EXPORT(name) __attribute__((export_name(name)))
+
+extern unsigned char __heap_base;
+
+static uint16_t* plane = 0;
+static float* output = 0;
+static int planeWidth = 0;
+static int planeHeight = 0;
+
+static int absolute(int value) {
+    return value < 0 ? -value : value;
+}
+
+// Make sure linear memory holds at least bytes past __heap_base
+static int reserve(size_t bytes) {
+    size_t end = (size_t)&__heap_base + bytes;
+    size_t pages = (end + 65535) / 65536;
+    size_t current = __builtin_wasm_memory_size(0);
+
+    if (pages > current && __builtin_wasm_memory_grow(0, pages - current) == (size_t)-1) {
+        return 0;
+    }
+    return 1;
+}
+
+// Allocate the plane for a frame size; returns its address (0 on failure).
+// The output buffer fits the in-frame part of any line.
+EXPORT("set_frame_size")
+uint16_t* set_frame_size(int width, int height) {
+    size_t planeBytes = ((size_t)width * height * sizeof(uint16_t) + 15) & ~(size_t)15;
+    size_t outputBytes = (size_t)(width > height ? width : height) * sizeof(float);
+
+    if (width <= 0 || height <= 0 || !reserve(planeBytes + outputBytes)) {
+        return 0;
+    }
+
+    plane = (uint16_t*)&__heap_base;
+    output = (float*)((unsigned char*)plane + planeBytes);
+    planeWidth = width;
+    planeHeight = height;
+    return plane;
+}
+
+EXPORT("output_buffer")
+float* output_buffer(void) {
+    return output;
+}
+
+// Sample the line into the output buffer; returns the number of samples.
+// Samples without a temperature (0) stay 0 like the server's profiles.
+EXPORT("sample_line")
+int sample_line(int x1, int y1, int x2, int y2) {
+    if (!plane) return 0;
+
+    int dx = absolute(x2 - x1);
+    int dy = absolute(y2 - y1);
+    int sx = x1 < x2 ? 1 : -1;
+    int sy = y1 < y2 ? 1 : -1;
+    int err = dx - dy;
+    int x = x1, y = y1;
+    int count = 0;
+
+    while (1) {
+        if (x >= 0 && x < planeWidth && y >= 0 && y < planeHeight) {
+            output[count++] = plane[(size_t)y * planeWidth + x] * 0.1f;
+        }
+
+        if (x == x2 && y == y2) break;
+
+        int e2 = 2 * err;
+        if (e2 > -dy) {
+            err -= dy;
+            x += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y += sy;
+        }
+    }
+
+    return count;
+}
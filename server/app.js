@@ -4,6 +4,8 @@ const path = require('path');
 const fs = require('fs');
 const ffmpeg = require('fluent-ffmpeg');
 const ffmpegPath = require('ffmpeg-static');
+const { QualityController } = require('./quality');
+const { FramePredictor } = require('./prefetch');
 
 // Set FFmpeg path to bundled binary
 ffmpeg.setFfmpegPath(ffmpegPath);
@@ -31,10 +33,58 @@ const VIDEO_PATH = '../videos/demo_vid.avi';
 const CSV_PATH = '../data/temp_mapping.csv';
 const TEMP_MP4_PATH = path.join(__dirname, '..', 'temp', 'demo_vid.mp4');
 
+// Engine-wide cache budget (frames, temperature data, results) in MB
+const CACHE_BUDGET_MB = parseFloat(process.env.CACHE_BUDGET_MB || '512');
+
+// Layout of cached frames: "interleaved" (served for display as is) or
+// "planar" (SIMD kernels, but every displayed frame is re-interleaved).
+// Batch jobs and live analysis always use planar frames.
+const FRAME_LAYOUT = process.env.FRAME_LAYOUT || 'interleaved';
+
+// Cached temperature data: "u16" (0.1 °C fixed point), "f16" or "f32"
+const TEMP_FORMAT = process.env.TEMP_FORMAT || 'u16';
+
+// Profile encodings clients may request instead of JSON number arrays.
+// 'delta' sends each line's profile relative to the previous one sent.
+const PROFILE_ENCODINGS = ['u16', 'f16', 'delta'];
+
+// Upper bound on the buckets a client may ask for per line (analyzeLine width)
+const MAX_PROFILE_BUCKETS = 4096;
+
+// Largest line coordinate magnitude the engine accepts (LINE_COORD_LIMIT in
+// native/geometry.cpp)
+const LINE_COORD_LIMIT = 1 << 28;
+
+// Temperature volume of the video (export with `npm run volume`). When it
+// exists, clients opened with ?tiles fetch compressed temperature tiles and
+// sample lines locally.
+const VOLUME_PATH = process.env.VOLUME_PATH || path.join(__dirname, '..', 'temp', 'demo_vid.tvol');
+const TILE_SIZE = 128;
+
+// Live capture source: "file:<growing.avi>", "pipe:<fifo>" or "stdin".
+// Raw pipe/stdin frames are packed BGR24 of LIVE_WIDTH x LIVE_HEIGHT.
+const LIVE_SOURCE = process.env.LIVE_SOURCE || null;
+const LIVE_WIDTH = parseInt(process.env.LIVE_WIDTH || '908');
+const LIVE_HEIGHT = parseInt(process.env.LIVE_HEIGHT || '1200');
+const LIVE_MAX_BUFFERED = 1024 * 1024; // Skip results for clients this far behind
+
 // Global state
 let videoInfo = null;
+let volumeInfo = null;
 let isEngineReady = false;
 
+// Live capture state: subscribed clients and the geometry each one watches
+const liveSubscribers = new Map();
+let isLiveRunning = false;
+let nextLiveSubscriberId = 1;
+
+// Shared review playback: viewers subscribed by session id, with their geometry
+const broadcastSubscribers = new Map();
+
+// Engine session per connection: its converted pixels are reused while a
+// line endpoint is dragged on the same frame
+let nextSessionId = 1;
+
 // Check if FFmpeg is installed
 function checkFFmpegInstalled() {
     return new Promise((resolve, reject) => {
@@ -173,6 +223,21 @@ async function initializeEngine() {
             throw new Error('Failed to load temperature mapping');
         }
         
+        // Bound all engine caches by one memory budget
+        thermalEngine.configureCache({ budgetMB: CACHE_BUDGET_MB });
+        thermalEngine.setFrameLayout(FRAME_LAYOUT);
+        thermalEngine.setTemperatureFormat(TEMP_FORMAT);
+        
+        // Optional temperature volume for client-side sampling
+        if (fs.existsSync(VOLUME_PATH)) {
+            volumeInfo = thermalEngine.openVolume(VOLUME_PATH);
+            if (volumeInfo) {
+                console.log(`✓ Temperature volume loaded: ${volumeInfo.frames} frames (${volumeInfo.format})`);
+            } else {
+                console.warn('✗ Failed to open temperature volume:', VOLUME_PATH);
+            }
+        }
+        
         // Get video information
         videoInfo = thermalEngine.getVideoInfo();
         console.log('Video Info:', videoInfo);
@@ -200,11 +265,27 @@ async function initializeEngine() {
 wss.on('connection', (ws) => {
     console.log('New WebSocket connection established');
     
+    // Adaptive playback quality, budget of one frame interval by default
+    ws.quality = new QualityController(1000 / ((videoInfo && videoInfo.fps) || 25));
+    ws.pendingAnalysis = null;
+    ws.analysisScheduled = false;
+    
+    // Slider motion model for frame prefetching
+    ws.predictor = new FramePredictor();
+    
+    // Last quantized profile sent per line, for delta encoding
+    ws.profileStreams = { line1: null, line2: null };
+    
+    ws.sessionId = nextSessionId++;
+    
+    // Handles of the queries this client prepared (see prepareQuery)
+    ws.queries = new Set();
+    
     // Send initial video info to client
     if (isEngineReady && videoInfo) {
         ws.send(JSON.stringify({
             type: 'videoInfo',
-            data: videoInfo,
+            data: { ...videoInfo, volume: volumeInfo },
             timestamp: Date.now()
         }));
     } else {
@@ -223,13 +304,65 @@ wss.on('connection', (ws) => {
             
             switch (message.type) {
                 case 'analyzeLine':
-                    await handleAnalyzeLine(ws, message.data);
+                    scheduleAnalyzeLine(ws, message.data);
                     break;
                     
                 case 'getPixelTemp':
                     await handleGetPixelTemp(ws, message.data);
                     break;
                     
+                case 'analyzePath':
+                    handleAnalyzePath(ws, message.data);
+                    break;
+                    
+                case 'analyzeRadial':
+                    handleAnalyzeRadial(ws, message.data);
+                    break;
+                    
+                case 'query':
+                    await handleQuery(ws, message.data);
+                    break;
+                    
+                case 'prepareQuery':
+                    handlePrepareQuery(ws, message.data);
+                    break;
+                    
+                case 'executeQuery':
+                    await handleExecuteQuery(ws, message.data);
+                    break;
+                    
+                case 'releaseQuery':
+                    handleReleaseQuery(ws, message.data);
+                    break;
+                    
+                case 'requestTiles':
+                    handleRequestTiles(ws, message.data);
+                    break;
+                    
+                case 'subscribeLive':
+                    handleSubscribeLive(ws, message.data || {});
+                    break;
+                    
+                case 'unsubscribeLive':
+                    unsubscribeLive(ws);
+                    break;
+                    
+                case 'startBroadcast':
+                    handleStartBroadcast(ws, message.data || {});
+                    break;
+                    
+                case 'stopBroadcast':
+                    stopBroadcast();
+                    break;
+                    
+                case 'subscribeBroadcast':
+                    handleSubscribeBroadcast(ws, message.data || {});
+                    break;
+                    
+                case 'unsubscribeBroadcast':
+                    unsubscribeBroadcast(ws);
+                    break;
+                    
                 case 'ping':
                     ws.send(JSON.stringify({
                         type: 'pong',
@@ -259,6 +392,14 @@ wss.on('connection', (ws) => {
     // Handle connection close
     ws.on('close', () => {
         console.log('WebSocket connection closed');
+        unsubscribeLive(ws);
+        unsubscribeBroadcast(ws);
+        if (isEngineReady) {
+            thermalEngine.releaseSession(ws.sessionId);
+            for (const handle of ws.queries) {
+                thermalEngine.releaseQuery(handle);
+            }
+        }
     });
     
     // Handle connection errors
@@ -267,6 +408,74 @@ wss.on('connection', (ws) => {
     });
 });
 
+// Statistics over the valid (> 0) samples of a profile
+function calculateStats(temps) {
+    if (temps.length === 0) return { avg: 0, max: 0, min: 0, count: 0 };
+    
+    const validTemps = temps.filter(t => t > 0);
+    if (validTemps.length === 0) return { avg: 0, max: 0, min: 0, count: 0 };
+    
+    const sum = validTemps.reduce((a, b) => a + b, 0);
+    return {
+        avg: sum / validTemps.length,
+        max: Math.max(...validTemps),
+        min: Math.min(...validTemps),
+        count: validTemps.length
+    };
+}
+
+// A series of temperatures in a fixed-size encoding (delta streams only
+// follow full resolution line profiles, so they fall back to u16), or as a
+// plain array
+function encodeSeries(values, encoding) {
+    if (!PROFILE_ENCODINGS.includes(encoding)) {
+        return Array.from(values);
+    }
+    
+    const format = encoding === 'delta' ? 'u16' : encoding;
+    return { format, data: thermalEngine.encodeTemperatures(values, format).toString('base64') };
+}
+
+// Fields of a bucketed profile result (analyzeLines / analyzePath buckets)
+function bucketFields(result, encoding) {
+    return {
+        buckets: {
+            length: result.length,
+            min: encodeSeries(result.min, encoding),
+            max: encodeSeries(result.max, encoding),
+            avg: encodeSeries(result.avg, encoding)
+        },
+        stats: result.stats
+    };
+}
+
+// Coalesce analysis requests per client: requests that arrive while one is
+// pending replace it, so an overloaded server drops stale frames instead of
+// answering them late
+function scheduleAnalyzeLine(ws, data) {
+    // Every request reflects slider motion, even those that get coalesced
+    if (data && typeof data.frameNum === 'number') {
+        ws.predictor.record(data.frameNum);
+    }
+    
+    if (ws.pendingAnalysis) {
+        ws.quality.skippedFrames++;
+    }
+    ws.pendingAnalysis = data;
+    
+    if (ws.analysisScheduled) {
+        return;
+    }
+    ws.analysisScheduled = true;
+    
+    setImmediate(async () => {
+        const pending = ws.pendingAnalysis;
+        ws.pendingAnalysis = null;
+        ws.analysisScheduled = false;
+        await handleAnalyzeLine(ws, pending);
+    });
+}
+
 // Handle line analysis requests
 async function handleAnalyzeLine(ws, data) {
     if (!isEngineReady) {
@@ -279,7 +488,7 @@ async function handleAnalyzeLine(ws, data) {
     }
     
     try {
-        const { frameNum, line1, line2 } = data;
+        const { frameNum, line1, line2, playing = false, latencyBudget, encoding, width } = data;
         
         // Validate parameters
         if (typeof frameNum !== 'number' || frameNum < 0 || frameNum >= videoInfo.frames) {
@@ -290,23 +499,12 @@ async function handleAnalyzeLine(ws, data) {
             throw new Error('Both line1 and line2 must be provided');
         }
         
-        // Validate line coordinates
-        const validateLine = (line, name) => {
-            const { x1, y1, x2, y2 } = line;
-            if (typeof x1 !== 'number' || typeof y1 !== 'number' || 
-                typeof x2 !== 'number' || typeof y2 !== 'number') {
-                throw new Error(`Invalid coordinates for ${name}`);
-            }
-            
-            // Clamp coordinates to video bounds
-            line.x1 = Math.max(0, Math.min(x1, videoInfo.width - 1));
-            line.y1 = Math.max(0, Math.min(y1, videoInfo.height - 1));
-            line.x2 = Math.max(0, Math.min(x2, videoInfo.width - 1));
-            line.y2 = Math.max(0, Math.min(y2, videoInfo.height - 1));
-        };
-        
-        validateLine(line1, 'line1');
-        validateLine(line2, 'line2');
+        // Pick quality for this client's latency budget (null = skip frame)
+        ws.quality.setBudget(latencyBudget);
+        const plan = ws.quality.plan(frameNum, playing);
+        if (!plan) {
+            return;
+        }
         
         // Analyze both lines
         console.log(`Analyzing frame ${frameNum} with lines:`, {
@@ -314,27 +512,51 @@ async function handleAnalyzeLine(ws, data) {
             line2: `(${line2.x1},${line2.y1}) -> (${line2.x2},${line2.y2})`
         });
         
-        const line1Temps = thermalEngine.analyzeLine(frameNum, line1.x1, line1.y1, line1.x2, line1.y2);
-        const line2Temps = thermalEngine.analyzeLine(frameNum, line2.x1, line2.y1, line2.x2, line2.y2);
+        // With a target width, lines come back as min/max/avg buckets (one per
+        // chart column) instead of every sample; without one at full resolution
+        const buckets = Number.isInteger(width) && width > 0 ? Math.min(width, MAX_PROFILE_BUCKETS) : 0;
+        
+        // Both lines go to the engine in one packed batch; it clips them to
+        // the frame. Packing would wrap large values into the frame, so only
+        // the engine's coordinate range is checked here.
+        const coordinates = [
+            line1.x1, line1.y1, line1.x2, line1.y2,
+            line2.x1, line2.y1, line2.x2, line2.y2
+        ];
+        if (!coordinates.every(value => Number.isFinite(value) && Math.abs(value) <= LINE_COORD_LIMIT)) {
+            throw new Error('Line coordinates must be numbers within ±' + LINE_COORD_LIMIT);
+        }
+        const lines = Int32Array.from(coordinates);
+        
+        const startTime = process.hrtime.bigint();
+        // Playback moves to a new frame with every request, so only edits on
+        // a still frame go through the session's converted pixels
+        const session = playing ? 0 : ws.sessionId;
+        const [line1Result, line2Result] = thermalEngine.analyzeLines(frameNum, lines, plan.level, buckets, session);
+        const analysisMs = Number(process.hrtime.bigint() - startTime) / 1e6;
+        
+        ws.quality.record(frameNum, analysisMs, plan);
         
-        // Calculate statistics
-        const calculateStats = (temps) => {
-            if (temps.length === 0) return { avg: 0, max: 0, min: 0, count: 0 };
+        // Compact profiles are sent base64 encoded; the client decodes them.
+        // Delta streams advance only once the message has been sent.
+        const streamUpdates = {};
+        const profileFields = (temps, stream) => {
+            if (!PROFILE_ENCODINGS.includes(encoding)) {
+                return { temperatures: Array.from(temps) };
+            }
             
-            const validTemps = temps.filter(t => t > 0);
-            if (validTemps.length === 0) return { avg: 0, max: 0, min: 0, count: 0 };
+            if (encoding === 'delta') {
+                const profile = thermalEngine.encodeProfile(temps, ws.profileStreams[stream]);
+                streamUpdates[stream] = profile.quantized;
+                return { encoded: { format: 'delta', key: profile.key, data: profile.data.toString('base64') } };
+            }
             
-            const sum = validTemps.reduce((a, b) => a + b, 0);
-            return {
-                avg: sum / validTemps.length,
-                max: Math.max(...validTemps),
-                min: Math.min(...validTemps),
-                count: validTemps.length
-            };
+            return { encoded: { format: encoding, data: thermalEngine.encodeTemperatures(temps, encoding).toString('base64') } };
         };
         
-        const line1Stats = calculateStats(line1Temps);
-        const line2Stats = calculateStats(line2Temps);
+        const lineFields = (result, stream) => buckets
+            ? bucketFields(result, encoding)
+            : { ...profileFields(result, stream), stats: calculateStats(result) };
         
         // Send results back to client
         ws.send(JSON.stringify({
@@ -342,18 +564,29 @@ async function handleAnalyzeLine(ws, data) {
             data: {
                 frameNum,
                 line1: {
-                    temperatures: line1Temps,
-                    stats: line1Stats,
+                    ...lineFields(line1Result, 'line1'),
                     coordinates: line1
                 },
                 line2: {
-                    temperatures: line2Temps,
-                    stats: line2Stats,
+                    ...lineFields(line2Result, 'line2'),
                     coordinates: line2
+                },
+                quality: {
+                    level: plan.level,
+                    frameSkip: plan.frameSkip,
+                    refined: plan.refined,
+                    analysisMs
                 }
             },
             timestamp: Date.now()
         }));
+        Object.assign(ws.profileStreams, streamUpdates);
+        
+        // While scrubbing, decode where the slider is heading in the background.
+        // Playback reads sequentially and does not need it.
+        if (!playing) {
+            thermalEngine.prefetchFrames(ws.predictor.predict(videoInfo.frames));
+        }
         
     } catch (error) {
         console.error('Error analyzing line:', error);
@@ -366,6 +599,288 @@ async function handleAnalyzeLine(ws, data) {
     }
 }
 
+// Handle a profile along a polyline or smooth (Catmull-Rom) path through
+// points [x0, y0, x1, y1, ...], e.g. following a curved rail head
+function handleAnalyzePath(ws, data) {
+    try {
+        const { frameNum, points, smooth = false, spacing = 1, level = 0, encoding, width } = data;
+        
+        if (!isEngineReady) {
+            throw new Error('Thermal engine not ready');
+        }
+        
+        if (typeof frameNum !== 'number' || frameNum < 0 || frameNum >= videoInfo.frames) {
+            throw new Error(`Invalid frame number: ${frameNum}`);
+        }
+        
+        if (!Array.isArray(points)) {
+            throw new Error('points must be an array of x, y pairs');
+        }
+        
+        // Same result fields as analyzeLine: buckets, encoded or temperatures
+        const buckets = Number.isInteger(width) && width > 0 ? Math.min(width, MAX_PROFILE_BUCKETS) : 0;
+        const result = thermalEngine.analyzePath(frameNum, Float32Array.from(points), {
+            smooth: Boolean(smooth),
+            spacing,
+            level,
+            buckets
+        });
+        
+        let path;
+        if (buckets) {
+            path = bucketFields(result, encoding);
+        } else {
+            const samples = encodeSeries(result, encoding);
+            path = {
+                ...(Array.isArray(samples) ? { temperatures: samples } : { encoded: samples }),
+                stats: calculateStats(result)
+            };
+        }
+        
+        ws.send(JSON.stringify({
+            type: 'pathResult',
+            data: { frameNum, path },
+            timestamp: Date.now()
+        }));
+        
+    } catch (error) {
+        console.error('Error analyzing path:', error);
+        ws.send(JSON.stringify({
+            type: 'error',
+            message: 'Failed to analyze path',
+            error: error.message,
+            timestamp: Date.now()
+        }));
+    }
+}
+
+// Handle a radial probe: mean temperature per 1-pixel ring around (x, y),
+// overall and per angular sector (spot welds, round workpieces)
+function handleAnalyzeRadial(ws, data) {
+    try {
+        const { frameNum, x, y, radius, sectors = 8, encoding } = data;
+        
+        if (!isEngineReady) {
+            throw new Error('Thermal engine not ready');
+        }
+        
+        if (typeof frameNum !== 'number' || frameNum < 0 || frameNum >= videoInfo.frames) {
+            throw new Error(`Invalid frame number: ${frameNum}`);
+        }
+        
+        const result = thermalEngine.analyzeRadial(frameNum, { x, y, radius, sectors });
+        if (!result) {
+            throw new Error(`Could not analyze frame ${frameNum}`);
+        }
+        
+        ws.send(JSON.stringify({
+            type: 'radialResult',
+            data: {
+                frameNum,
+                center: { x, y },
+                radius,
+                radial: encodeSeries(result.radial, encoding),
+                sectors: result.sectors.map(sector => encodeSeries(sector, encoding)),
+                stats: result.stats
+            },
+            timestamp: Date.now()
+        }));
+        
+    } catch (error) {
+        console.error('Error analyzing radial profile:', error);
+        ws.send(JSON.stringify({
+            type: 'error',
+            message: 'Failed to analyze radial profile',
+            error: error.message,
+            timestamp: Date.now()
+        }));
+    }
+}
+
+// Fields of a query result: temperature outputs (profile, kymograph) are
+// sent in the requested encoding as one series of rows * cols values; stats
+// become one object per frame and histograms plain counts
+function queryResultFields(result, encoding) {
+    return {
+        frames: Array.from(result.frames),
+        valid: Array.from(result.valid, v => v === 1),
+        outputs: result.outputs.map(output => {
+            const fields = { geometry: output.geometry, reduce: output.reduce, rows: output.rows, cols: output.cols };
+            
+            if (output.reduce === 'stats') {
+                fields.stats = [];
+                for (let row = 0; row < output.rows; row++) {
+                    const [min, max, avg, count] = output.data.subarray(row * 4, row * 4 + 4);
+                    fields.stats.push({ avg, max, min, count });
+                }
+            } else if (output.reduce === 'histogram') {
+                fields.counts = Array.from(output.data);
+            } else {
+                fields.values = encodeSeries(output.data, encoding);
+            }
+            
+            return fields;
+        })
+    };
+}
+
+function sendQueryError(ws, message, error) {
+    console.error(`${message}:`, error);
+    ws.send(JSON.stringify({
+        type: 'error',
+        message,
+        error: error.message,
+        timestamp: Date.now()
+    }));
+}
+
+// Handle a batched query: geometries x frames x outputs, answered from one
+// native plan (see runQuery) instead of one message per profile or value.
+// Runs on the engine's executors, so other clients are served meanwhile.
+async function handleQuery(ws, data) {
+    try {
+        const { id, geometries, frames, outputs, level = 0, encoding } = data;
+        
+        if (!isEngineReady) {
+            throw new Error('Thermal engine not ready');
+        }
+        
+        const result = await thermalEngine.runQueryAsync({ geometries, frames, outputs, level });
+        
+        ws.send(JSON.stringify({
+            type: 'queryResult',
+            data: { id, ...queryResultFields(result, encoding) },
+            timestamp: Date.now()
+        }));
+        
+    } catch (error) {
+        sendQueryError(ws, 'Failed to run query', error);
+    }
+}
+
+// Prepare a query once (geometries, outputs, level) for repeated execution
+// on new frames, e.g. a dashboard following playback
+function handlePrepareQuery(ws, data) {
+    try {
+        const { id, geometries, outputs, level = 0 } = data;
+        
+        if (!isEngineReady) {
+            throw new Error('Thermal engine not ready');
+        }
+        
+        const handle = thermalEngine.prepareQuery({ geometries, outputs, level });
+        ws.queries.add(handle);
+        
+        ws.send(JSON.stringify({
+            type: 'queryPrepared',
+            data: { id, handle },
+            timestamp: Date.now()
+        }));
+        
+    } catch (error) {
+        sendQueryError(ws, 'Failed to prepare query', error);
+    }
+}
+
+// Execute a prepared query of this client on frames
+async function handleExecuteQuery(ws, data) {
+    try {
+        const { id, handle, frames, encoding } = data;
+        
+        if (!isEngineReady) {
+            throw new Error('Thermal engine not ready');
+        }
+        
+        if (!ws.queries.has(handle)) {
+            throw new Error(`Unknown query handle: ${handle}`);
+        }
+        
+        const result = await thermalEngine.executeQueryAsync(handle, frames);
+        
+        ws.send(JSON.stringify({
+            type: 'queryResult',
+            data: { id, handle, ...queryResultFields(result, encoding) },
+            timestamp: Date.now()
+        }));
+        
+    } catch (error) {
+        sendQueryError(ws, 'Failed to execute query', error);
+    }
+}
+
+function handleReleaseQuery(ws, data) {
+    const { handle } = data;
+    
+    if (ws.queries.delete(handle) && isEngineReady) {
+        thermalEngine.releaseQuery(handle);
+    }
+}
+
+const MAX_TILE_FRAMES = 32;
+
+function tilesMessage(frameNum, tiles) {
+    return JSON.stringify({
+        type: 'tiles',
+        data: {
+            frameNum,
+            width: volumeInfo.width,
+            height: volumeInfo.height,
+            available: tiles !== null,
+            tiles: (tiles || []).map(tile => ({
+                x: tile.x,
+                y: tile.y,
+                width: tile.width,
+                height: tile.height,
+                data: tile.data.toString('base64')
+            }))
+        },
+        timestamp: Date.now()
+    });
+}
+
+// Send the compressed temperature tiles of a frame for client-side sampling.
+// available is false when the volume does not hold the frame. Given frames
+// (e.g. the next frames of playback), one 'tiles' message is sent per frame
+// and the frames are read from the volume in one batch.
+function handleRequestTiles(ws, data) {
+    try {
+        const { frameNum, frames } = data;
+        
+        if (!isEngineReady || !volumeInfo) {
+            throw new Error('No temperature volume loaded');
+        }
+        
+        const requested = frames !== undefined ? frames : [frameNum];
+        
+        if (!Array.isArray(requested) || requested.length > MAX_TILE_FRAMES) {
+            throw new Error(`frames must be an array of at most ${MAX_TILE_FRAMES} frame numbers`);
+        }
+        
+        for (const frame of requested) {
+            if (typeof frame !== 'number' || frame < 0 || frame >= videoInfo.frames) {
+                throw new Error(`Invalid frame number: ${frame}`);
+            }
+        }
+        
+        if (frames === undefined) {
+            ws.send(tilesMessage(frameNum, thermalEngine.getVolumeTiles(frameNum, TILE_SIZE)));
+            return;
+        }
+        
+        const tileSets = thermalEngine.getVolumeTiles(requested, TILE_SIZE);
+        requested.forEach((frame, i) => ws.send(tilesMessage(frame, tileSets[i])));
+        
+    } catch (error) {
+        console.error('Error sending tiles:', error);
+        ws.send(JSON.stringify({
+            type: 'error',
+            message: 'Failed to send temperature tiles',
+            error: error.message,
+            timestamp: Date.now()
+        }));
+    }
+}
+
 // Handle pixel temperature requests
 async function handleGetPixelTemp(ws, data) {
     if (!isEngineReady) {
@@ -408,6 +923,318 @@ async function handleGetPixelTemp(ws, data) {
     }
 }
 
+// Parse LIVE_SOURCE into native live capture options
+function getLiveSourceOptions() {
+    if (!LIVE_SOURCE) {
+        return null;
+    }
+    
+    const separator = LIVE_SOURCE.indexOf(':');
+    const source = separator >= 0 ? LIVE_SOURCE.slice(0, separator) : LIVE_SOURCE;
+    const sourcePath = separator >= 0 ? LIVE_SOURCE.slice(separator + 1) : '';
+    
+    return { source, path: sourcePath, width: LIVE_WIDTH, height: LIVE_HEIGHT };
+}
+
+// Merge the geometry and alarm rules of all subscribers into one native
+// configuration. Each subscriber remembers where its lines and ROIs start in
+// the merged lists; rule ids are prefixed with the subscriber id for routing.
+function buildLiveConfig() {
+    const lines = [];
+    const rois = [];
+    const rules = [];
+    
+    for (const subscription of liveSubscribers.values()) {
+        subscription.lineOffset = lines.length;
+        subscription.roiOffset = rois.length;
+        
+        for (const rule of subscription.rules) {
+            const offset = rule.source === 'line' ? subscription.lineOffset : subscription.roiOffset;
+            rules.push({ ...rule, id: `${subscription.id}:${rule.id}`, index: rule.index + offset });
+        }
+        
+        lines.push(...subscription.lines);
+        rois.push(...subscription.rois);
+    }
+    
+    return { lines, rois, rules };
+}
+
+// Split a native live result and send each subscriber its own slice.
+// Alarm events are always delivered, even to clients that are behind.
+function publishLiveResult(result) {
+    if (result.ended) {
+        endLiveCapture(result.frame);
+        return;
+    }
+    
+    for (const [client, subscription] of liveSubscribers) {
+        if (client.readyState !== WebSocket.OPEN) {
+            continue;
+        }
+        
+        const prefix = `${subscription.id}:`;
+        for (const alarm of result.alarms) {
+            if (!alarm.rule.startsWith(prefix)) continue;
+            
+            client.send(JSON.stringify({
+                type: 'alarm',
+                data: { ...alarm, rule: alarm.rule.slice(prefix.length) },
+                timestamp: Date.now()
+            }));
+        }
+        
+        if (client.bufferedAmount > LIVE_MAX_BUFFERED) {
+            continue;
+        }
+        
+        const lines = subscription.lines.map((coordinates, i) => ({
+            ...result.lines[subscription.lineOffset + i],
+            coordinates
+        }));
+        const rois = subscription.rois.map((region, i) => ({
+            stats: result.rois[subscription.roiOffset + i],
+            region
+        }));
+        
+        client.send(JSON.stringify({
+            type: 'liveResult',
+            data: {
+                frame: result.frame,
+                captureTime: result.timestamp,
+                latencyMs: result.latencyMs,
+                droppedFrames: result.droppedFrames,
+                lines,
+                rois
+            },
+            timestamp: Date.now()
+        }));
+    }
+}
+
+function startLiveCapture() {
+    const options = getLiveSourceOptions();
+    if (!options) {
+        throw new Error('Live capture not configured (set LIVE_SOURCE)');
+    }
+    
+    isLiveRunning = thermalEngine.startLive({ ...options, ...buildLiveConfig() }, publishLiveResult);
+    if (!isLiveRunning) {
+        throw new Error(`Failed to open live source: ${LIVE_SOURCE}`);
+    }
+    console.log('✓ Live capture started:', LIVE_SOURCE);
+}
+
+function stopLiveCapture() {
+    if (isLiveRunning) {
+        thermalEngine.stopLive();
+        isLiveRunning = false;
+        console.log('✓ Live capture stopped');
+    }
+}
+
+// The live source ran out or broke: tell every subscriber and drop the
+// subscriptions, so the next subscribe starts a new capture
+function endLiveCapture(lastFrame) {
+    console.log(`Live source ended after frame ${lastFrame}:`, LIVE_SOURCE);
+    stopLiveCapture();
+    
+    for (const client of liveSubscribers.keys()) {
+        if (client.readyState === WebSocket.OPEN) {
+            client.send(JSON.stringify({
+                type: 'liveEnded',
+                data: { source: LIVE_SOURCE, lastFrame },
+                timestamp: Date.now()
+            }));
+        }
+    }
+    liveSubscribers.clear();
+}
+
+// Handle live subscription requests; resubscribing replaces geometry and rules
+function handleSubscribeLive(ws, data) {
+    const previous = liveSubscribers.get(ws);
+    
+    try {
+        const { lines = [], rois = [], rules = [] } = data;
+        
+        if (!Array.isArray(lines) || !Array.isArray(rois) || !Array.isArray(rules)) {
+            throw new Error('lines, rois and rules must be arrays');
+        }
+        
+        const id = previous ? previous.id : nextLiveSubscriberId++;
+        liveSubscribers.set(ws, { id, lines, rois, rules, lineOffset: 0, roiOffset: 0 });
+        
+        if (isLiveRunning) {
+            thermalEngine.configureLive(buildLiveConfig());
+        } else {
+            startLiveCapture();
+        }
+        
+        ws.send(JSON.stringify({
+            type: 'liveSubscribed',
+            data: { source: LIVE_SOURCE, lines: lines.length, rois: rois.length, rules: rules.length },
+            timestamp: Date.now()
+        }));
+        
+    } catch (error) {
+        console.error('Error subscribing to live capture:', error);
+        
+        // Keep the previous subscription if the new one was rejected
+        if (previous && isLiveRunning) {
+            liveSubscribers.set(ws, previous);
+            thermalEngine.configureLive(buildLiveConfig());
+        } else {
+            unsubscribeLive(ws);
+        }
+        ws.send(JSON.stringify({
+            type: 'error',
+            message: 'Failed to subscribe to live capture',
+            error: error.message,
+            timestamp: Date.now()
+        }));
+    }
+}
+
+function unsubscribeLive(ws) {
+    if (!liveSubscribers.delete(ws)) {
+        return;
+    }
+    
+    if (liveSubscribers.size === 0) {
+        stopLiveCapture();
+    } else {
+        thermalEngine.configureLive(buildLiveConfig());
+    }
+}
+
+// Send a broadcast result to the viewer it was computed for
+function publishBroadcastResult(subscriberId, result) {
+    if (result.ended) {
+        endBroadcast(result.frame);
+        return;
+    }
+    
+    const subscriber = broadcastSubscribers.get(subscriberId);
+    if (!subscriber) return;
+    
+    const { ws, lines, rois } = subscriber;
+    if (ws.readyState !== WebSocket.OPEN || ws.bufferedAmount > LIVE_MAX_BUFFERED) {
+        return;
+    }
+    
+    ws.send(JSON.stringify({
+        type: 'broadcastResult',
+        data: {
+            frame: result.frame,
+            latencyMs: result.latencyMs,
+            skippedFrames: result.droppedFrames,
+            lines: lines.map((coordinates, i) => ({ ...result.lines[i], coordinates })),
+            rois: rois.map((region, i) => ({ stats: result.rois[i], region }))
+        },
+        timestamp: Date.now()
+    }));
+}
+
+function sendBroadcastState(type, extra = {}) {
+    const state = { ...thermalEngine.getBroadcastState(), ...extra };
+    for (const { ws } of broadcastSubscribers.values()) {
+        if (ws.readyState === WebSocket.OPEN) {
+            ws.send(JSON.stringify({ type, data: state, timestamp: Date.now() }));
+        }
+    }
+}
+
+// Playback reached the end of the recording. Viewers stay subscribed and
+// follow the next broadcast that is started.
+function endBroadcast(lastFrame) {
+    console.log(`Broadcast ended at frame ${lastFrame}`);
+    thermalEngine.stopBroadcast();
+    sendBroadcastState('broadcastStopped', { ended: true, lastFrame });
+}
+
+// Start (or restart) shared playback at a frame; every viewer follows it.
+// Restarting drops the native subscribers, so they are added again.
+function handleStartBroadcast(ws, data) {
+    try {
+        const { frameNum = 0, rate = 1 } = data;
+        
+        if (!isEngineReady) {
+            throw new Error('Thermal engine not ready');
+        }
+        
+        if (!thermalEngine.startBroadcast({ start: frameNum, rate }, publishBroadcastResult)) {
+            throw new Error('Failed to start broadcast');
+        }
+        
+        for (const [id, { lines, rois }] of broadcastSubscribers) {
+            thermalEngine.subscribeBroadcast(id, { lines, rois });
+        }
+        
+        console.log(`✓ Broadcast started at frame ${frameNum} (${rate}x)`);
+        sendBroadcastState('broadcastStarted');
+        
+    } catch (error) {
+        console.error('Error starting broadcast:', error);
+        ws.send(JSON.stringify({
+            type: 'error',
+            message: 'Failed to start broadcast',
+            error: error.message,
+            timestamp: Date.now()
+        }));
+    }
+}
+
+function stopBroadcast() {
+    if (isEngineReady) {
+        thermalEngine.stopBroadcast();
+        sendBroadcastState('broadcastStopped');
+    }
+}
+
+// Subscribe to the shared playback; resubscribing replaces lines and ROIs
+function handleSubscribeBroadcast(ws, data) {
+    try {
+        const { lines = [], rois = [] } = data;
+        
+        if (!Array.isArray(lines) || !Array.isArray(rois)) {
+            throw new Error('lines and rois must be arrays');
+        }
+        
+        if (!isEngineReady) {
+            throw new Error('Thermal engine not ready');
+        }
+        
+        // Kept while no broadcast runs; added natively once one starts
+        const state = thermalEngine.getBroadcastState();
+        if (state.running && !thermalEngine.subscribeBroadcast(ws.sessionId, { lines, rois })) {
+            throw new Error('Too many broadcast viewers');
+        }
+        broadcastSubscribers.set(ws.sessionId, { ws, lines, rois });
+        
+        ws.send(JSON.stringify({
+            type: 'broadcastSubscribed',
+            data: { ...state, lines: lines.length, rois: rois.length },
+            timestamp: Date.now()
+        }));
+        
+    } catch (error) {
+        console.error('Error subscribing to broadcast:', error);
+        ws.send(JSON.stringify({
+            type: 'error',
+            message: 'Failed to subscribe to broadcast',
+            error: error.message,
+            timestamp: Date.now()
+        }));
+    }
+}
+
+function unsubscribeBroadcast(ws) {
+    if (broadcastSubscribers.delete(ws.sessionId) && isEngineReady) {
+        thermalEngine.unsubscribeBroadcast(ws.sessionId);
+    }
+}
+
 // REST API endpoints
 app.get('/api/video-info', (req, res) => {
     if (!isEngineReady || !videoInfo) {
@@ -423,13 +1250,24 @@ app.get('/api/video-info', (req, res) => {
     });
 });
 
+app.get('/api/cache-stats', (req, res) => {
+    res.json(thermalEngine.getCacheStats());
+});
+
 app.get('/api/health', (req, res) => {
     res.json({
         status: 'ok',
         engineReady: isEngineReady,
         timestamp: Date.now(),
         uptime: process.uptime(),
-        tempFileExists: fs.existsSync(TEMP_MP4_PATH)
+        tempFileExists: fs.existsSync(TEMP_MP4_PATH),
+        cache: isEngineReady ? thermalEngine.getCacheStats() : null,
+        live: {
+            source: LIVE_SOURCE,
+            running: isLiveRunning,
+            subscribers: liveSubscribers.size
+        },
+        broadcast: isEngineReady ? thermalEngine.getBroadcastState() : null
     });
 });
 
@@ -479,6 +1317,9 @@ async function startServer() {
 function shutdown(signal) {
     console.log(`\nReceived ${signal}, shutting down gracefully...`);
     
+    // Stop live capture threads
+    stopLiveCapture();
+    
     // Close WebSocket server
     wss.close(() => {
         console.log('✓ WebSocket server closed');
@@ -0,0 +1,143 @@
+// Golden-reference envelope QA for the recording archive
+//
+// Usage:
+//   node envelope.js build <envelope.tenv> <good1.avi> [good2.avi ...] [--lines lines.json] [--bins 200]
+//   node envelope.js score <envelope.tenv> <rec1.avi> [rec2.avi ...] [--tolerance 5] [--percentiles]
+//
+// lines.json holds an array of { x1, y1, x2, y2 } in video pixel coordinates.
+// Without it the default horizontal and vertical lines of the web UI are used.
+
+const fs = require('fs');
+const path = require('path');
+
+let thermalEngine;
+try {
+    thermalEngine = require('../native/build/Release/thermal_engine');
+} catch (error) {
+    console.error('✗ Failed to load native thermal engine:', error.message);
+    console.error('Make sure to build the native module first:');
+    console.error('  cd native && npm install && node-gyp rebuild');
+    process.exit(1);
+}
+
+const CSV_PATH = path.join(__dirname, '..', 'data', 'temp_mapping.csv');
+
+// Split argv into positional arguments and --options
+function parseArgs(argv) {
+    const positional = [];
+    const options = {};
+
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (arg === '--percentiles') {
+            options.percentiles = true;
+        } else if (arg.startsWith('--')) {
+            options[arg.slice(2)] = argv[++i];
+        } else {
+            positional.push(arg);
+        }
+    }
+
+    return { positional, options };
+}
+
+// Same default geometry as adjustLinePositions() in public/app.js
+function defaultLines(videoPath) {
+    if (!thermalEngine.loadVideo(videoPath)) {
+        throw new Error(`Failed to load video file: ${videoPath}`);
+    }
+
+    const { width, height } = thermalEngine.getVideoInfo();
+    return [
+        {
+            x1: Math.round(width * 0.1), y1: Math.round(height * 0.5),
+            x2: Math.round(width * 0.9), y2: Math.round(height * 0.5)
+        },
+        {
+            x1: Math.round(width * 0.5), y1: Math.round(height * 0.1),
+            x2: Math.round(width * 0.5), y2: Math.round(height * 0.9)
+        }
+    ];
+}
+
+function build(envelopePath, videoPaths, options) {
+    const lines = options.lines
+        ? JSON.parse(fs.readFileSync(options.lines, 'utf8'))
+        : defaultLines(videoPaths[0]);
+    const bins = options.bins ? parseInt(options.bins) : 200;
+
+    const startTime = Date.now();
+    const success = thermalEngine.buildEnvelope(videoPaths, lines, envelopePath, bins);
+    if (!success) {
+        throw new Error('Failed to build envelope');
+    }
+
+    const duration = ((Date.now() - startTime) / 1000).toFixed(1);
+    console.log(`✓ Envelope written to ${envelopePath} (${videoPaths.length} recordings, ${duration}s)`);
+}
+
+function score(envelopePath, videoPaths, options) {
+    let failed = 0;
+
+    for (const videoPath of videoPaths) {
+        const startTime = Date.now();
+        const result = thermalEngine.scoreEnvelope(videoPath, envelopePath, {
+            tolerance: options.tolerance ? parseFloat(options.tolerance) : 0,
+            usePercentiles: !!options.percentiles
+        });
+        const duration = ((Date.now() - startTime) / 1000).toFixed(1);
+
+        // Nothing scored: the envelope or the recording could not be read
+        if (result.frames === 0) {
+            failed++;
+            console.log(`✗ ${videoPath}: no frames scored (unreadable recording or envelope)`);
+            continue;
+        }
+
+        if (result.flaggedFrames.length === 0) {
+            console.log(`✓ ${videoPath}: ${result.frames} frames within envelope (${duration}s)`);
+            continue;
+        }
+
+        failed++;
+        console.log(`✗ ${videoPath}: ${result.flaggedFrames.length}/${result.frames} frames out of envelope (${duration}s)`);
+        for (const v of result.violations.slice(0, 20)) {
+            console.log(`    frame ${v.frame} line ${v.line} ${v.measure}=${v.value.toFixed(1)} ` +
+                        `outside [${v.lo.toFixed(1)}, ${v.hi.toFixed(1)}]`);
+        }
+        if (result.violations.length > 20) {
+            console.log(`    ... ${result.violations.length - 20} more`);
+        }
+    }
+
+    return failed;
+}
+
+function main() {
+    const [command, ...rest] = process.argv.slice(2);
+    const { positional, options } = parseArgs(rest);
+    const [envelopePath, ...videoPaths] = positional;
+
+    if (!['build', 'score'].includes(command) || !envelopePath || videoPaths.length === 0) {
+        console.error('Usage: node envelope.js build|score <envelope.tenv> <video.avi> [...]');
+        process.exit(2);
+    }
+
+    if (!thermalEngine.loadTempMapping(CSV_PATH)) {
+        console.error('✗ Failed to load temperature mapping:', CSV_PATH);
+        process.exit(1);
+    }
+
+    try {
+        if (command === 'build') {
+            build(envelopePath, videoPaths, options);
+        } else {
+            process.exit(score(envelopePath, videoPaths, options) > 0 ? 3 : 0);
+        }
+    } catch (error) {
+        console.error('✗', error.message);
+        process.exit(1);
+    }
+}
+
+main();
@@ -0,0 +1,87 @@
+// Slider-driven frame prediction for background prefetching
+//
+// The recent stream of frame requests from a client is fitted with a line
+// (frames per millisecond) to estimate where the slider is heading. Frames on
+// the way to the predicted position come first, then a neighbourhood around
+// it, nearest first, so the native prefetcher decodes the likeliest frames
+// before the client asks for them.
+
+const HISTORY_SIZE = 8;
+const HISTORY_WINDOW_MS = 500;
+const LOOKAHEAD_MS = 300;
+const NEIGHBOURHOOD = 6;
+const MAX_PREFETCH = 32;
+
+class FramePredictor {
+    constructor() {
+        this.history = [];
+    }
+
+    record(frameNum, time = Date.now()) {
+        this.history.push({ frameNum, time });
+        if (this.history.length > HISTORY_SIZE) {
+            this.history.shift();
+        }
+    }
+
+    // Least-squares slope of frame over time for the recent window, in frames/ms
+    velocity() {
+        const latest = this.history[this.history.length - 1];
+        const recent = this.history.filter(h => latest.time - h.time <= HISTORY_WINDOW_MS);
+        if (recent.length < 2) {
+            return 0;
+        }
+
+        const meanT = recent.reduce((sum, h) => sum + h.time, 0) / recent.length;
+        const meanF = recent.reduce((sum, h) => sum + h.frameNum, 0) / recent.length;
+
+        let covariance = 0;
+        let variance = 0;
+        for (const h of recent) {
+            covariance += (h.time - meanT) * (h.frameNum - meanF);
+            variance += (h.time - meanT) ** 2;
+        }
+
+        return variance > 0 ? covariance / variance : 0;
+    }
+
+    // Frames to prefetch, most likely first
+    predict(totalFrames) {
+        if (this.history.length === 0 || totalFrames <= 0) {
+            return [];
+        }
+
+        const current = this.history[this.history.length - 1].frameNum;
+        const projected = Math.round(current + this.velocity() * LOOKAHEAD_MS);
+        const target = Math.max(0, Math.min(projected, totalFrames - 1));
+        const direction = target >= current ? 1 : -1;
+
+        const frames = [];
+        const seen = new Set([current]);
+        const add = (frame) => {
+            if (frame >= 0 && frame < totalFrames && !seen.has(frame) && frames.length < MAX_PREFETCH) {
+                seen.add(frame);
+                frames.push(frame);
+            }
+        };
+
+        // Path the slider is expected to sweep through, nearest first; a fast
+        // fling leaves the rest of the budget for where it will stop
+        const pathBudget = MAX_PREFETCH - (2 * NEIGHBOURHOOD + 1);
+        for (let frame = current + direction; frame !== target + direction && frames.length < pathBudget; frame += direction) {
+            add(frame);
+        }
+
+        // The predicted stop and its neighbourhood, leaning in the direction
+        // of motion
+        add(target);
+        for (let offset = 1; offset <= NEIGHBOURHOOD; offset++) {
+            add(target + direction * offset);
+            add(target - direction * offset);
+        }
+
+        return frames;
+    }
+}
+
+module.exports = { FramePredictor };
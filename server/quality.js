@@ -0,0 +1,84 @@
+// Adaptive analysis quality per WebSocket client
+//
+// Each client gets a latency budget (one video frame by default). When the
+// measured analysis time exceeds it, quality is reduced step by step: first a
+// coarser pyramid level (fewer samples per line), then skipped frames. When
+// there is headroom again the steps are undone in reverse order. Requests
+// made while playback is paused always run at full quality.
+
+const MAX_LEVEL = 3;
+const MAX_FRAME_SKIP = 4;
+const SMOOTHING = 0.3;
+const RECOVER_RATIO = 0.5;
+
+class QualityController {
+    constructor(budgetMs) {
+        this.budgetMs = budgetMs;
+        this.level = 0;
+        this.frameSkip = 0;
+        this.averageMs = null;
+        this.lastFrame = null;
+        this.skippedFrames = 0;
+    }
+
+    setBudget(budgetMs) {
+        if (typeof budgetMs === 'number' && budgetMs > 0) {
+            this.budgetMs = budgetMs;
+        }
+    }
+
+    // Decide how to analyze a request; returns null when the frame should be skipped
+    plan(frameNum, playing) {
+        if (!playing) {
+            return { level: 0, frameSkip: 0, refined: true };
+        }
+
+        if (this.frameSkip > 0 && this.lastFrame !== null &&
+            Math.abs(frameNum - this.lastFrame) <= this.frameSkip) {
+            this.skippedFrames++;
+            return null;
+        }
+
+        return { level: this.level, frameSkip: this.frameSkip, refined: false };
+    }
+
+    // Record how long an analysis took and adapt for the next request
+    record(frameNum, elapsedMs, plan) {
+        this.lastFrame = frameNum;
+
+        // Full-quality refinements are not representative of playback load
+        if (plan.refined) {
+            return;
+        }
+
+        this.averageMs = this.averageMs === null
+            ? elapsedMs
+            : this.averageMs + SMOOTHING * (elapsedMs - this.averageMs);
+
+        if (this.averageMs > this.budgetMs) {
+            if (this.level < MAX_LEVEL) {
+                this.level++;
+            } else if (this.frameSkip < MAX_FRAME_SKIP) {
+                this.frameSkip++;
+            }
+        } else if (this.averageMs < this.budgetMs * RECOVER_RATIO) {
+            if (this.frameSkip > 0) {
+                this.frameSkip--;
+            } else if (this.level > 0) {
+                this.level--;
+            }
+        }
+    }
+
+    getState() {
+        return {
+            level: this.level,
+            frameSkip: this.frameSkip,
+            averageMs: this.averageMs,
+            budgetMs: this.budgetMs,
+            skippedFrames: this.skippedFrames
+        };
+    }
+}
+
+module.exports = { QualityController };
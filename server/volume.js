@@ -0,0 +1,79 @@
+// Export a recording as a temperature volume (.tvol)
+//
+// Usage:
+//   node volume.js <video.avi> <volume.tvol> [--format u16|f16|f32] [--start 0] [--end N] [--step 1]
+//
+// u16 (0.1 °C fixed point) is the default; it keeps 0.1 °C resolution at half
+// the size of f32. f16 has only 0.5-1 °C steps above 512 °C.
+
+const path = require('path');
+
+let thermalEngine;
+try {
+    thermalEngine = require('../native/build/Release/thermal_engine');
+} catch (error) {
+    console.error('✗ Failed to load native thermal engine:', error.message);
+    console.error('Make sure to build the native module first:');
+    console.error('  cd native && npm install && node-gyp rebuild');
+    process.exit(1);
+}
+
+const CSV_PATH = path.join(__dirname, '..', 'data', 'temp_mapping.csv');
+
+// Split argv into positional arguments and --options
+function parseArgs(argv) {
+    const positional = [];
+    const options = {};
+
+    for (let i = 0; i < argv.length; i++) {
+        const arg = argv[i];
+        if (arg.startsWith('--')) {
+            options[arg.slice(2)] = argv[++i];
+        } else {
+            positional.push(arg);
+        }
+    }
+
+    return { positional, options };
+}
+
+function main() {
+    const { positional, options } = parseArgs(process.argv.slice(2));
+    const [videoPath, volumePath] = positional;
+
+    if (!videoPath || !volumePath) {
+        console.error('Usage: node volume.js <video.avi> <volume.tvol> [--format u16|f16|f32] [--start n] [--end n] [--step n]');
+        process.exit(2);
+    }
+
+    if (!thermalEngine.loadTempMapping(CSV_PATH)) {
+        console.error('✗ Failed to load temperature mapping:', CSV_PATH);
+        process.exit(1);
+    }
+
+    if (!thermalEngine.loadVideo(videoPath)) {
+        console.error('✗ Failed to load video file:', videoPath);
+        process.exit(1);
+    }
+
+    try {
+        const startTime = Date.now();
+        const exportOptions = { format: options.format || 'u16' };
+        if (options.start) exportOptions.start = parseInt(options.start);
+        if (options.end) exportOptions.end = parseInt(options.end);
+        if (options.step) exportOptions.step = parseInt(options.step);
+
+        const result = thermalEngine.exportVolume(volumePath, exportOptions);
+        if (!result.success) {
+            throw new Error('Failed to export temperature volume');
+        }
+
+        const duration = ((Date.now() - startTime) / 1000).toFixed(1);
+        console.log(`✓ Volume written to ${volumePath} (${result.frames} frames, ${result.format}, ${duration}s)`);
+    } catch (error) {
+        console.error('✗', error.message);
+        process.exit(1);
+    }
+}
+
+main();